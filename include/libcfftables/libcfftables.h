@@ -77,6 +77,7 @@ extern "C" {
 
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdint.h>
 
 
 /* ============================================================================
@@ -278,13 +279,668 @@ void cff_write(const cff_t *cff, FILE *file);
  * This function iterates of all n choose d+1 subset of columns an ensures that
  * each 1-weight d+1 size tuple is present in each subset of columns.
  *
+ * For `d = 1, 2, 3` the check runs on a packed copy of the columns with specialized
+ * kernels (64 rows per machine word), which is much faster than the generic check
+ * used for larger `d`.
+ *
+ * CFFs from the tables are checked with `cff_verify_with_symmetry()`, using the
+ * symmetries of the constructions they were built from (for `d <= 3` only when they
+ * save more than the kernels gain).
+ *
  * @param cff The CFF to verify.
  *
  * @return true if the CFF is valid, false otherwise.
  */
 bool cff_verify(const cff_t *cff);
+/**
+ * @brief Verify a CFF, checking only one subset of columns per orbit of a group of column symmetries.
+ *
+ * An automorphism of a CFF is a permutation of its columns that maps its rows onto its rows (as
+ * sets of columns). It maps cover free subsets to cover free subsets, so when the columns fall into
+ * orbits under a group of automorphisms it is enough to check the subsets that contain the smallest
+ * column of some orbit and otherwise only columns of later orbits. If the group is transitive, these
+ * are the `n-1 choose d` subsets containing column 0, instead of all `n choose d+1`.
+ *
+ * The group is given by generators, which are checked before they are used: a generator that is not
+ * an automorphism is ignored, so the result is a complete proof either way. If no generators are
+ * given and the CFF came from the tables, the generators are taken from the constructions it was
+ * built from (translations and scalings of Reed-Solomon codewords, point shifts of Steiner triple
+ * systems and Sperner families, lifted through Kronecker, additive and extend-by-one steps).
+ *
+ * For `d <= 3` the specialized kernels of `cff_verify()` check every subset instead, unless the
+ * orbits cut the number of subsets to check by more than the kernels' speedup (about 16 times).
+ *
+ * @param cff The CFF to verify.
+ * @param generators `num_generators` column permutations, one after the other, each an array of `n`
+ * column indices (`generators[g * n + c]` is the image of column `c` under generator `g`). May be NULL.
+ * @param num_generators The number of generators.
+ *
+ * @return true if the CFF is valid, false otherwise.
+ */
+bool cff_verify_with_symmetry(const cff_t *cff, const long long *generators, int num_generators);
+/**
+ * @brief Split the columns of a CFF into the orbits `cff_verify_with_symmetry()` uses.
+ *
+ * The generators are checked and used the same way as in `cff_verify_with_symmetry()`.
+ *
+ * @param cff The CFF.
+ * @param generators `num_generators` column permutations, as for `cff_verify_with_symmetry()`.
+ * May be NULL.
+ * @param num_generators The number of generators.
+ * @param orbit_of If not NULL, an array of `n` entries that receives the orbit of each column. Orbits
+ * are numbered from 0 in the order of their smallest columns.
+ *
+ * @return The number of orbits (`n` when no symmetry was found), or -1 if the CFF is NULL or memory
+ * could not be allocated.
+ */
+int cff_column_orbits(const cff_t *cff, const long long *generators, int num_generators, int *orbit_of);
+/**
+ * @brief Compute the largest d for which a matrix is a d-CFF.
+ *
+ * The `d` stored in the CFF is ignored. A matrix is a d-CFF when no column is contained in the
+ * union of d other columns, so for each column this searches for the smallest set of other columns
+ * whose union contains it. Sets of size s are built from the stored unions of the sets of size s-1,
+ * and only sets whose last column adds rows are kept, so this is much cheaper than calling
+ * `cff_verify()` for every d. The search for each column stops at the best size found so far, and
+ * sets that leave more rows than could be covered below it are dropped. At most 1 MiB of sets is
+ * stored; past that the search goes on depth first from the last stored size, so memory stays
+ * bounded for strong CFFs.
+ *
+ * @param cff The CFF.
+ * @param[out] witness If not NULL, receives the d+1 columns (in increasing order) whose union contains
+ * the column `*uncovered`, so these columns and `*uncovered` show that the matrix is not a (d+1)-CFF.
+ * `*uncovered` is the lowest column with such a set. At most `witness_capacity` columns are written.
+ * @param witness_capacity The length of the `witness` array.
+ * @param[out] uncovered If not NULL, receives the column contained in the union of the witness, or
+ * -1 if there is none (when the result is n-1).
+ *
+ * @return The largest d, which is n-1 if no column is covered by the others. Returns -1 if a column
+ * is empty (`*uncovered` is set to it), or if memory could not be allocated.
+ */
+int cff_compute_max_d(const cff_t *cff, long long *witness, int witness_capacity, long long *uncovered);
+/**
+ * @brief Result of `cff_verify_ex()`.
+ */
+typedef enum cff_verify_status
+{
+    CFF_VERIFY_ERROR = -1,    /**< invalid arguments, or memory could not be allocated */
+    CFF_VERIFY_VALID = 0,     /**< every subset of d+1 columns was checked and is cover free */
+    CFF_VERIFY_INVALID = 1,   /**< a subset of d+1 columns is not cover free */
+    CFF_VERIFY_CANCELLED = 2, /**< the cancellation flag was set; the checkpoint (if any) holds the cursor */
+    CFF_VERIFY_CHECKPOINT_FAILED = 3 /**< the checkpoint could not be written; verification stopped there */
+} cff_verify_status_t;
+/**
+ * @brief Options for `cff_verify_ex()`. Zero-initialize it and set the fields you need.
+ */
+typedef struct cff_verify_options
+{
+    /** Called after every `checkpoint_interval` subsets with the number of subsets checked so far
+     * and the total `n choose d+1` (0 if the total does not fit in a long long). May be NULL. */
+    void (*progress)(long long checked, long long total, void *user_data);
+    /** Passed through to `progress`. */
+    void *user_data;
+    /** Polled after every `checkpoint_interval` subsets; verification stops once it is nonzero.
+     * May be NULL. */
+    const volatile int *cancel;
+    /** Number of subsets between progress reports, cancellation checks and checkpoints.
+     * 0 uses a default of about four million. */
+    long long checkpoint_interval;
+    /** File the subset cursor is saved to. If it holds a checkpoint for the same matrix when
+     * `cff_verify_ex()` starts, verification resumes from it. The file is removed once
+     * verification finishes (but not when it is cancelled). May be NULL. */
+    const char *checkpoint_path;
+} cff_verify_options_t;
+/**
+ * @brief Verify a CFF like `cff_verify()`, with progress reports, cancellation, checkpoints
+ * and a witness on failure.
+ *
+ * The subsets of d+1 columns are checked in lexicographic order. Every `checkpoint_interval`
+ * subsets the progress callback is called, the cursor is written to the checkpoint file and the
+ * cancellation flag is polled, so a run that is cancelled or killed can be resumed by calling
+ * this function again with the same checkpoint path. If the checkpoint cannot be written (e.g. the
+ * directory is not writable or the disk is full), verification stops with
+ * `CFF_VERIFY_CHECKPOINT_FAILED` rather than run on without a way to resume; the previous
+ * checkpoint, if any, is left in place.
+ *
+ * @param cff The CFF to verify.
+ * @param options The options, or NULL for none.
+ * @param[out] witness If not NULL and the CFF is invalid, receives the d+1 columns (in increasing
+ * order) of the first subset that is not cover free.
+ * @param[out] uncovered If not NULL and the CFF is invalid, receives the column of the witness
+ * that is covered by the other d columns.
+ *
+ * @return A `cff_verify_status_t`.
+ */
+cff_verify_status_t cff_verify_ex(const cff_t *cff, const cff_verify_options_t *options,
+                                  long long *witness, long long *uncovered);
+/**
+ * @brief Certify a CFF from the tables using the theorems behind its construction.
+ *
+ * A CFF returned by `cff_table_get_by_t()`/`cff_table_get_by_n()` remembers the recipe it was
+ * built from: direct constructions (Reed-Solomon, Sperner, STS, ...) combined by recursive
+ * constructions (Kronecker, additive, doubling, ...), and recursive constructions applied to such
+ * CFFs extend their recipes. Each step has a theorem behind it, so
+ * instead of checking all `n choose d+1` subsets of columns this function checks the parameters
+ * of the direct constructions and the preconditions of each recursive construction. This takes
+ * time linear in the size of the matrix, so it can certify products far too large for `cff_verify()`.
+ *
+ * The check fails if any cell of the CFF was changed after it was constructed, or if its `d`
+ * was raised above the `d` of the table it came from with `cff_set_d()`.
+ *
+ * @param cff The CFF to certify.
+ *
+ * @return true if the CFF is certified to be a valid `d-CFF(t,n)`, false otherwise. For a CFF that
+ * did not come from the tables, this returns `cff_verify(cff)`.
+ */
+bool cff_verify_by_construction(const cff_t *cff);
+/**
+ * @brief Opaque handle for growing a CFF one column at a time.
+ *
+ * The columns appended to a `cff_incremental_t` always form a d-CFF: `cff_incremental_append()`
+ * only checks the subsets of d+1 columns that contain the new column, and rejects the column if
+ * one of them is not cover free. This makes greedy and local search constructions practical,
+ * where calling `cff_verify()` after every column would check all `n choose d+1` subsets again.
+ */
+typedef struct cff_incremental cff_incremental_t;
+/**
+ * @brief Create an empty incremental d-CFF with t rows.
+ *
+ * @param d The d of the CFF.
+ * @param t The number of rows of every column.
+ *
+ * @return A new `cff_incremental_t`, or NULL if d or t is invalid or memory could not be allocated.
+ */
+cff_incremental_t* cff_incremental_create(int d, int t);
+/**
+ * @brief Free a `cff_incremental_t`.
+ *
+ * @param inc The `cff_incremental_t` to free. May be NULL.
+ */
+void cff_incremental_free(cff_incremental_t *inc);
+/**
+ * @brief Append a column if the columns stay a d-CFF.
+ *
+ * Checks every subset made of the new column and d of the existing columns (or all of them, while
+ * there are d or fewer). A column with no 1s is always rejected.
+ *
+ * @param inc The `cff_incremental_t` to append to.
+ * @param column An array of t values (0 or 1): the cells of the new column.
+ *
+ * @return true if the column was appended, false if it would break the d-CFF property (in which
+ * case nothing changes).
+ */
+bool cff_incremental_append(cff_incremental_t *inc, const int *column);
+/**
+ * @brief Get the number of columns appended so far.
+ *
+ * @param inc The `cff_incremental_t`.
+ *
+ * @return The number of columns.
+ */
+long long cff_incremental_get_n(const cff_incremental_t *inc);
+/**
+ * @brief Copy the columns appended so far into a new `cff_t`.
+ *
+ * @param inc The `cff_incremental_t`.
+ *
+ * @return A new d-CFF(t, n) that must be freed with `cff_free()`, or NULL if no columns were
+ * appended or memory could not be allocated.
+ */
+cff_t* cff_incremental_to_cff(const cff_incremental_t *inc);
 /** @} */ // end of core group
 
+/* ============================================================================
+ * Group Testing
+ * ============================================================================ */
+/**
+ * @defgroup testing Group Testing
+ * @brief Decoding test outcomes and encoding positive items with a CFF
+ *
+ * A `d-CFF(t,n)` is a non-adaptive group testing design for `n` items and `t` tests: row `r` is a
+ * test that pools the items `c` with a 1 in cell `(r, c)`, and its outcome is positive when it
+ * pools at least one positive item. Up to `d` positive items are always identified exactly.
+ *
+ * Outcome vectors are packed like the rows of the incidence matrix: the outcome of test `r` is bit
+ * `r % 8` of byte `r / 8`, so an outcome vector for `t` tests is `(t + 7) / 8` bytes long.
+ * @{
+ */
+/**
+ * @brief Decode the outcomes of the tests of a CFF.
+ *
+ * Every item pooled in a negative test is negative; the items that are left are returned as
+ * positive (the COMP decoder). For a d-CFF and at most `d` positive items, this is exactly the
+ * set of positive items. If more than `d` items are returned, the outcomes did not come from `d`
+ * or fewer positive items, and the result contains every positive item but may contain negatives.
+ *
+ * The decoder clears the items of each negative test from a bitmap of candidates 64 items at a
+ * time, reading the rows of the matrix directly.
+ *
+ * @param cff The CFF whose rows are the tests.
+ * @param outcomes The packed outcome vector.
+ * @param[out] positives Receives the positive items in increasing order. At most `max_positives` are
+ * written. May be NULL to only count them.
+ * @param max_positives The length of the `positives` array.
+ *
+ * @return The number of positive items (which may be larger than `max_positives`), or -1 if an
+ * argument is NULL or memory could not be allocated.
+ */
+long long cff_decode(const cff_t *cff, const unsigned char *outcomes,
+                     long long *positives, long long max_positives);
+/**
+ * @brief Decode a batch of outcome vectors of the tests of a CFF in one pass over its rows.
+ *
+ * Gives the same result as calling `cff_decode()` on each vector, but the vectors are bit-sliced so
+ * that the matrix is read once for the whole batch: word `j` of row `r`,
+ * `sliced_outcomes[r * W + j]` where `W = (batch_size + 63) / 64`, holds the outcome of test `r` in
+ * vectors `64j` to `64j + 63` (vector `64j + b` in bit `b`). An item's result in 64 vectors is then
+ * the AND of the words of the tests it is pooled in. Besides the output, it takes `n * W` words.
+ *
+ * @param cff The CFF whose rows are the tests.
+ * @param sliced_outcomes `t * W` words of bit-sliced outcomes.
+ * @param batch_size The number of outcome vectors.
+ * @param[out] positives Receives the positive items of vector `b` in increasing order, in
+ * `positives[b * max_positives_per_vector]` onwards. At most `max_positives_per_vector` are written
+ * per vector. May be NULL to only count them.
+ * @param max_positives_per_vector The space for each vector in `positives`.
+ * @param[out] counts Receives the number of positive items of each vector (`batch_size` entries),
+ * which may be larger than `max_positives_per_vector`.
+ *
+ * @return 0 on success, -1 if an argument is invalid or memory could not be allocated.
+ */
+int cff_decode_batch(const cff_t *cff, const uint64_t *sliced_outcomes, int batch_size,
+                     long long *positives, long long max_positives_per_vector, long long *counts);
+/**
+ * @brief Opaque handle for decoding test outcomes as they arrive.
+ *
+ * A `cff_decoder_t` takes the outcomes of the tests of a CFF one at a time, in any order, and can
+ * be asked at any point which items are known to be negative (pooled in a negative test), known
+ * to be positive (the only item of a positive test that is not known to be negative), and which
+ * are still ambiguous. Once every outcome is in, the items not known to be negative are the result
+ * of `cff_decode()`.
+ */
+typedef struct cff_decoder cff_decoder_t;
+/**
+ * @brief What is known about an item while outcomes arrive.
+ */
+typedef enum cff_item_status
+{
+    CFF_ITEM_NEGATIVE,  /**< pooled in a negative test */
+    CFF_ITEM_POSITIVE,  /**< the only item of a positive test that is not negative */
+    CFF_ITEM_AMBIGUOUS  /**< neither of the above yet */
+} cff_item_status_t;
+/**
+ * @brief Create a decoder for the tests of a CFF, with no outcomes yet.
+ *
+ * @param cff The CFF whose rows are the tests. It is not copied, and must not be changed or freed
+ * while the decoder is in use.
+ *
+ * @return A new `cff_decoder_t`, or NULL if `cff` is NULL or memory could not be allocated.
+ */
+cff_decoder_t* cff_decoder_create(const cff_t *cff);
+/**
+ * @brief Free a `cff_decoder_t`.
+ *
+ * @param dec The `cff_decoder_t` to free. May be NULL.
+ */
+void cff_decoder_free(cff_decoder_t *dec);
+/**
+ * @brief Give the decoder the outcome of one test.
+ *
+ * A negative outcome removes the items of the test from the candidates with one AND-NOT per 64
+ * items.
+ *
+ * @param dec The `cff_decoder_t`.
+ * @param test The row of the test.
+ * @param positive The outcome of the test.
+ *
+ * @return 0 on success, -1 if `test` is out of range or its outcome was already given.
+ */
+int cff_decoder_add_outcome(cff_decoder_t *dec, int test, bool positive);
+/**
+ * @brief Get the number of tests whose outcomes have been given.
+ *
+ * @param dec The `cff_decoder_t`.
+ *
+ * @return The number of outcomes given so far, or -1 if `dec` is NULL.
+ */
+int cff_decoder_get_num_outcomes(const cff_decoder_t *dec);
+/**
+ * @brief Get the items with a given status from the outcomes so far.
+ *
+ * @param dec The `cff_decoder_t`.
+ * @param status Which items to get.
+ * @param[out] items Receives the items (column indices) in increasing order. At most `max_items`
+ * are written. May be NULL to only count them.
+ * @param max_items The length of the `items` array.
+ *
+ * @return The number of items with the status (which may be larger than `max_items`), or -1 if an
+ * argument is invalid or memory could not be allocated.
+ */
+long long cff_decoder_get_items(const cff_decoder_t *dec, cff_item_status_t status,
+                                long long *items, long long max_items);
+/**
+ * @brief Opaque handle for decoding by looking up precomputed outcome vectors.
+ *
+ * Every set of at most `d` positive items of a `d-CFF` gives a different outcome vector, so for
+ * small designs all of them can be computed once and stored in a hash table, and decoding is a
+ * single lookup instead of a pass over the matrix. Use `cff_syndrome_index_estimate_size()` to see
+ * how much memory that takes before building one.
+ */
+typedef struct cff_syndrome_index cff_syndrome_index_t;
+/**
+ * @brief Get the number of bytes `cff_syndrome_index_create(cff, d)` would allocate.
+ *
+ * @param cff The CFF whose rows are the tests.
+ * @param d The largest number of positive items to index.
+ *
+ * @return The size in bytes, or -1 if an argument is invalid or the size does not fit in a `long long`.
+ */
+long long cff_syndrome_index_estimate_size(const cff_t *cff, int d);
+/**
+ * @brief Index the outcome vectors of every set of at most `d` positive items.
+ *
+ * There are `n choose 0 + ... + n choose d` sets, so this is meant for small `d` and `n` (for
+ * example `d <= 2` and `n` in the thousands).
+ *
+ * @param cff The CFF whose rows are the tests. It is not needed once the index is built.
+ * @param d The largest number of positive items to index, at most the `d` of the CFF.
+ *
+ * @return A new `cff_syndrome_index_t`, or NULL if `d` is invalid, two sets of at most `d` items
+ * have the same outcomes (the CFF is not really a `d-CFF`), or memory could not be allocated.
+ */
+cff_syndrome_index_t* cff_syndrome_index_create(const cff_t *cff, int d);
+/**
+ * @brief Free a `cff_syndrome_index_t`.
+ *
+ * @param idx The `cff_syndrome_index_t` to free. May be NULL.
+ */
+void cff_syndrome_index_free(cff_syndrome_index_t *idx);
+/**
+ * @brief Decode an outcome vector with one hash table lookup.
+ *
+ * @param idx The `cff_syndrome_index_t`.
+ * @param outcomes The packed outcome vector: the outcome of test `r` is bit `r % 8` of byte `r / 8`.
+ * @param[out] positives Receives the positive items (column indices) in increasing order. At most
+ * `max_positives` are written. May be NULL to only count them.
+ * @param max_positives The length of the `positives` array.
+ *
+ * @return The number of positive items, or -1 if an argument is NULL or the outcomes are not those
+ * of any set of at most `d` positive items.
+ */
+long long cff_syndrome_index_lookup(const cff_syndrome_index_t *idx, const unsigned char *outcomes,
+                                    long long *positives, long long max_positives);
+/**
+ * @brief Compute the test outcomes of a batch of positive sets.
+ *
+ * This is the boolean product of the incidence matrix with the item-by-batch matrix, bit-sliced
+ * like `cff_decode_batch()`: word `j` of item `c`, `sliced_items[c * W + j]` where
+ * `W = (batch_size + 63) / 64`, says whether item `c` is positive in vectors `64j` to `64j + 63`
+ * (vector `64j + b` in bit `b`), and the outcomes are written the same way for each test. It uses
+ * the Method of Four Russians: for each group of 8 items (one byte of a row of the matrix) a table
+ * of the ORs of their 256 subsets is built once, and each test ORs one entry of it per group.
+ *
+ * @param cff The CFF whose rows are the tests.
+ * @param sliced_items `n * W` words of bit-sliced positive items.
+ * @param batch_size The number of positive sets.
+ * @param[out] sliced_outcomes Receives `t * W` words of bit-sliced outcomes, which can be passed
+ * to `cff_decode_batch()`.
+ * @param num_threads The number of threads to split the items between (values below 1 mean 1).
+ *
+ * @return 0 on success, -1 if an argument is invalid or memory could not be allocated.
+ */
+int cff_encode_batch(const cff_t *cff, const uint64_t *sliced_items, int batch_size,
+                     uint64_t *sliced_outcomes, int num_threads);
+/**
+ * @brief Opaque handle for building the pools of the tests as items arrive.
+ *
+ * Each arriving item is given a column of the CFF and is appended to the pool of every test in
+ * that column, found from the set bits of the packed column, so the pools are filled as items
+ * come in instead of by a pass over the whole `t * n` matrix at the end. A test's pool is complete
+ * once every column in the test has an item, and complete pools are handed to a callback in
+ * batches.
+ */
+typedef struct cff_pool_encoder cff_pool_encoder_t;
+/**
+ * @brief Callback receiving a batch of pools from a `cff_pool_encoder_t`.
+ *
+ * The pools are released when the callback returns, so it must copy anything it keeps.
+ *
+ * @param num_pools The number of pools in the batch.
+ * @param tests The row of the test of each pool.
+ * @param pools The items of each pool, in the order they were added.
+ * @param pool_sizes The number of items of each pool.
+ * @param user_data The pointer given to `cff_pool_encoder_create()`.
+ */
+typedef void (*cff_pool_flush_fn)(int num_pools, const int *tests, const long long *const *pools,
+                                  const long long *pool_sizes, void *user_data);
+/**
+ * @brief Create a pool encoder for the tests of a CFF, with no items yet.
+ *
+ * @param cff The CFF whose rows are the tests. It is not needed once the encoder is created.
+ * @param batch_size The number of complete pools to collect before calling `flush`.
+ * @param flush The callback receiving the complete pools.
+ * @param user_data Passed to `flush`. May be NULL.
+ *
+ * @return A new `cff_pool_encoder_t`, or NULL if an argument is invalid or memory could not be
+ * allocated.
+ */
+cff_pool_encoder_t* cff_pool_encoder_create(const cff_t *cff, int batch_size, cff_pool_flush_fn flush,
+                                            void *user_data);
+/**
+ * @brief Free a `cff_pool_encoder_t`, dropping the pools not yet flushed.
+ *
+ * @param enc The `cff_pool_encoder_t` to free. May be NULL.
+ */
+void cff_pool_encoder_free(cff_pool_encoder_t *enc);
+/**
+ * @brief Add an arriving item to the pools of the tests of its column.
+ *
+ * If this completes `batch_size` or more pools, they are all passed to the callback.
+ *
+ * @param enc The `cff_pool_encoder_t`.
+ * @param item An identifier for the item, stored in the pools.
+ * @param column The column of the CFF given to the item.
+ *
+ * @return 0 on success, -1 if `column` is out of range, already has an item, is in a test whose
+ * pool was already passed to the callback (by `cff_pool_encoder_flush()` with `incomplete`), or
+ * memory could not be allocated.
+ */
+int cff_pool_encoder_add(cff_pool_encoder_t *enc, long long item, long long column);
+/**
+ * @brief Pass the complete pools waiting for a full batch to the callback.
+ *
+ * @param enc The `cff_pool_encoder_t`.
+ * @param incomplete Whether to also pass the pools of tests that still have columns without an
+ * item (for example at the end of intake when not every column was used).
+ *
+ * @return The number of pools passed to the callback, or -1 if `enc` is NULL.
+ */
+int cff_pool_encoder_flush(cff_pool_encoder_t *enc, bool incomplete);
+/**
+ * @brief Get the items added so far to the pool of a test that has not been flushed.
+ *
+ * @param enc The `cff_pool_encoder_t`.
+ * @param test The row of the test.
+ * @param[out] size Receives the number of items of the pool.
+ *
+ * @return The items of the pool in the order they were added, NULL if the pool is empty or was
+ * flushed (with `size` set to 0), or NULL if an argument is invalid.
+ */
+const long long* cff_pool_encoder_get_pool(const cff_pool_encoder_t *enc, int test, long long *size);
+/**
+ * @brief Decode noisy test outcomes by the fraction of each item's tests that are positive.
+ *
+ * `cff_decode()` drops an item as soon as one of its tests is negative, so a single false negative
+ * loses a positive item. This decoder scores each item by the fraction of its tests that came back
+ * positive, counted in one pass over the rows of the matrix (64 items at a time, without copying
+ * it), and reports the items whose score is at least `threshold`. With `threshold = 1` it gives the same
+ * result as `cff_decode()` (for CFFs without empty columns). Items in no test are never reported.
+ *
+ * @param cff The CFF whose rows are the tests.
+ * @param outcomes The packed outcome vector: the outcome of test `r` is bit `r % 8` of byte `r / 8`.
+ * @param threshold The smallest fraction of positive tests for an item to be reported.
+ * @param[out] positives Receives the positive items (column indices) in increasing order. At most
+ * `max_positives` are written. May be NULL to only count them.
+ * @param max_positives The length of the `positives` array.
+ *
+ * @return The number of positive items (which may be larger than `max_positives`), or -1 if an
+ * argument is NULL or memory could not be allocated.
+ */
+long long cff_decode_threshold(const cff_t *cff, const unsigned char *outcomes, double threshold,
+                               long long *positives, long long max_positives);
+/**
+ * @brief Get the `k` items most likely to be positive from noisy test outcomes.
+ *
+ * Items are scored as in `cff_decode_threshold()` and ranked by score, then by their number of
+ * positive tests, then by column index.
+ *
+ * @param cff The CFF whose rows are the tests.
+ * @param outcomes The packed outcome vector: the outcome of test `r` is bit `r % 8` of byte `r / 8`.
+ * @param k The number of items to get.
+ * @param[out] items Receives the `min(k, n)` best items (column indices), best first.
+ * @param[out] scores Receives the score of each of them. May be NULL.
+ *
+ * @return The number of items written, `min(k, n)`, or -1 if an argument is invalid or memory
+ * could not be allocated.
+ */
+long long cff_decode_top_k(const cff_t *cff, const unsigned char *outcomes, long long k,
+                           long long *items, double *scores);
+/**
+ * @brief Decode the outcomes of the tests of `cff_reed_solomon(p, exp, t, m)` without building it.
+ *
+ * An item (a codeword) is positive when each of its `m` symbols falls in a positive test of its
+ * group of `q = p^exp` tests. Any `t` symbols determine a codeword, so the decoder takes the `t`
+ * groups with the fewest positive tests, interpolates a codeword through every choice of their
+ * positive symbols and keeps those whose other symbols are positive too. With at most `d`
+ * positive items that is at most `d^t` interpolations: the cost depends on `t`, `m` and `q`, but
+ * not on the `q^t` columns. The field arithmetic goes through tables of logarithms of size `O(q)`,
+ * built on each call. The result is the same as `cff_decode()` on the constructed CFF.
+ *
+ * @param p The prime of the alphabet.
+ * @param exp The power of the alphabet.
+ * @param t Message length of the Reed-Solomon code.
+ * @param m Codeword size of the Reed-Solomon code.
+ * @param outcomes The packed outcome vector of the `m * q` tests.
+ * @param[out] positives Receives the positive items (column indices) in increasing order. At most
+ * `max_positives` are written. May be NULL to only count them.
+ * @param max_positives The length of the `positives` array.
+ *
+ * @pre The preconditions of `cff_reed_solomon()`.
+ *
+ * @return The number of positive items, or -1 if the parameters are invalid (including `m * q`
+ * tests that do not fit in an `int`) or memory could not be allocated.
+ */
+long long cff_reed_solomon_decode(int p, int exp, int t, int m, const unsigned char *outcomes,
+                                  long long *positives, long long max_positives);
+/**
+ * @brief Decode the outcomes of the tests of `cff_short_reed_solomon(p, exp, t, m, s)` without building it.
+ *
+ * Works like `cff_reed_solomon_decode()` on the shortened code, and numbers the codewords the way
+ * `cff_short_reed_solomon()` numbers its columns.
+ *
+ * @param p The prime of the alphabet.
+ * @param exp The power of the alphabet.
+ * @param t Message length of the Reed-Solomon code.
+ * @param m Codeword size of the Reed-Solomon code.
+ * @param s Number of times the code is shortened.
+ * @param outcomes The packed outcome vector of the `(m - s) * q` tests.
+ * @param[out] positives Receives the positive items (column indices) in increasing order. At most
+ * `max_positives` are written. May be NULL to only count them.
+ * @param max_positives The length of the `positives` array.
+ *
+ * @pre The preconditions of `cff_short_reed_solomon()`.
+ *
+ * @return The number of positive items, or -1 if the parameters are invalid (including `(m - s) * q`
+ * tests that do not fit in an `int`) or memory could not be allocated.
+ */
+long long cff_short_reed_solomon_decode(int p, int exp, int t, int m, int s, const unsigned char *outcomes,
+                                        long long *positives, long long max_positives);
+/**
+ * @brief Decode the outcomes of the tests of `cff_sperner(n)` without building it.
+ *
+ * Column `j` of `cff_sperner(n)` is the `j`-th `t/2`-subset of the `t` tests in lexicographic
+ * order, so a single positive item is found by ranking the set of positive tests with
+ * `cff_sperner_rank()`, in `O(t)` time and no memory. With more positive items, every `t/2`-subset
+ * of the positive tests is reported. The result is the same as `cff_decode()` on the constructed CFF.
+ *
+ * @param n The number of columns of the Sperner CFF.
+ * @param outcomes The packed outcome vector of the `t` tests.
+ * @param[out] positives Receives the positive items (column indices) in increasing order. At most
+ * `max_positives` are written. May be NULL to only count them.
+ * @param max_positives The length of the `positives` array.
+ *
+ * @return The number of positive items, or -1 if `n < 1` or `outcomes` is NULL.
+ */
+long long cff_sperner_decode(int n, const unsigned char *outcomes, long long *positives, long long max_positives);
+/**
+ * @brief Find the column of `cff_sperner(n)` with the given set of tests.
+ *
+ * @param n The number of columns of the Sperner CFF.
+ * @param tests The rows of the column, in increasing order.
+ * @param num_tests The length of `tests`, which is `t/2` for a column of the CFF.
+ *
+ * @return The column index, or -1 if no column of `cff_sperner(n)` has exactly these tests.
+ */
+long long cff_sperner_rank(int n, const int *tests, int num_tests);
+/**
+ * @brief Get the tests of a column of `cff_sperner(n)` without building it. Inverse of `cff_sperner_rank()`.
+ *
+ * @param n The number of columns of the Sperner CFF.
+ * @param column The column index, `0 <= column < n`.
+ * @param[out] tests Receives the `t/2` rows of the column in increasing order.
+ *
+ * @return The number of tests written (`t/2`), or -1 if the column is out of range.
+ */
+int cff_sperner_unrank(int n, long long column, int *tests);
+/**
+ * @brief Decode the outcomes of the tests of `cff_sts(v)` without building it.
+ *
+ * Each column of `cff_sts(v)` is a block of 3 points (tests), and each pair of points is in exactly
+ * one block, which the Bose and Skolem constructions give by a formula. So the positive items are
+ * found by looking up the block through each pair of positive tests and keeping those whose third
+ * point is positive too, in time polynomial in the number of positive tests and without reading
+ * any matrix. The result is the same as `cff_decode()` on the constructed CFF.
+ *
+ * @param v The order of the Steiner triple system (`v` = 1 or 3 mod 6), the number of tests.
+ * @param outcomes The packed outcome vector of the `v` tests.
+ * @param[out] positives Receives the positive items (column indices) in increasing order. At most
+ * `max_positives` are written. May be NULL to only count them.
+ * @param max_positives The length of the `positives` array.
+ *
+ * @return The number of positive items, or -1 if `v` is not 1 or 3 mod 6, `outcomes` is NULL, or
+ * memory could not be allocated.
+ */
+long long cff_sts_decode(int v, const unsigned char *outcomes, long long *positives, long long max_positives);
+/**
+ * @brief Decode the outcomes of the tests of a CFF by following how it was constructed.
+ *
+ * A CFF returned by `cff_table_get_by_t()` or `cff_table_get_by_n()` remembers the constructions
+ * it was built from, and so does a product built from such CFFs with `cff_additive()`,
+ * `cff_extend_by_one()`, `cff_doubling()`, `cff_kronecker()` or `cff_optimized_kronecker()`.
+ * Each construction is decoded with its own decoder: additive and extend by one
+ * products split into independent blocks of rows, a Kronecker product decodes its left factor in
+ * each block of rows with a positive test and then its right factor only for the left columns that
+ * survived, a doubling checks the rows below its two copies, Reed-Solomon CFFs use the list decoder
+ * of `cff_reed_solomon_decode()` and `cff_short_reed_solomon_decode()` (setting up each field once
+ * per call), and other base CFFs are built (once per call) and decoded with `cff_decode()`. With few positive items the work depends on the sizes of the
+ * components, not on the number of columns of the product.
+ *
+ * The result is the same as `cff_decode()`. CFFs without a construction recipe (or whose `t` or `n`
+ * no longer match it) are decoded with `cff_decode()`.
+ *
+ * @param cff The CFF whose rows are the tests.
+ * @param outcomes The packed outcome vector: the outcome of test `r` is bit `r % 8` of byte `r / 8`.
+ * @param[out] positives Receives the positive items (column indices) in increasing order. At most
+ * `max_positives` are written. May be NULL to only count them.
+ * @param max_positives The length of the `positives` array.
+ *
+ * @return The number of positive items (which may be larger than `max_positives`), or -1 if an
+ * argument is NULL or memory could not be allocated.
+ */
+long long cff_decode_by_construction(const cff_t *cff, const unsigned char *outcomes,
+                                     long long *positives, long long max_positives);
+/** @} */ // end of testing group
+
 /* ============================================================================
  * Table Generation
  * ============================================================================ */
@@ -322,6 +978,16 @@ typedef struct cff_table_ctx cff_table_ctx_t;
  * After creating the tables, CFFs can be constructed from the table by using the functions
  * `cff_table_get_by_n()` and `cff_table_get_by_t()`.
  *
+ * Every recursive construction makes a CFF from CFFs with smaller `t`, so each table is filled in a
+ * single pass of increasing `t` in which a row takes the best of its candidates from the finished
+ * rows below it. The tables for different `d` are built at the same time on the available cores,
+ * each following just behind the table for `d - 1`; the result does not depend on the number of
+ * cores.
+ *
+ * Unless the library was built with `CFF_EMBED_TABLES` off, the tables for `d` up to 25 and `n` up
+ * to 100 trillion are linked into it, and for any bounds within those (any `t_maximum`) the tables
+ * are cut from them instead of being built.
+ *
  * The tables should be freed once they are not needed anymore with `cff_table_free()`.
  *
  * @param d_maximum The maximum `d` that will appear in the tables.
@@ -331,6 +997,24 @@ typedef struct cff_table_ctx cff_table_ctx_t;
  * @return A `cff_table_ctx_t` that stores the created tables.
  */
 cff_table_ctx_t* cff_table_create(int d_maximum, int t_maximum, long long n_maximum);
+/**
+ * @brief Extends the tables to larger bounds, keeping the rows that are already built.
+ *
+ * Afterwards the tables are the same as `cff_table_create()` would make for the new bounds. Only
+ * the new tables, the new rows and the row where a table stopped growing at the old `n_maximum`
+ * (and the rows after it) are built; every other row is final for any bounds and is kept. A bound
+ * smaller than the current one is left as it is.
+ *
+ * CFFs constructed from the tables before extending them stay valid.
+ *
+ * @param ctx The tables to extend. Must be initialized with `cff_table_create()` or `cff_table_load()`.
+ * @param d_maximum The new maximum `d` that will appear in the tables.
+ * @param t_maximum The new maximum `t` that will appear in the tables.
+ * @param n_maximum The new maximum `n` that will appear in the tables.
+ *
+ * @return 0 on success, or -1 if `ctx` is NULL or the tables cannot be grown (they are then unchanged).
+ */
+int cff_table_extend(cff_table_ctx_t *ctx, int d_maximum, int t_maximum, long long n_maximum);
 /**
  * @brief Frees a `cff_table_ctx_t` from memory
  *
@@ -385,6 +1069,40 @@ cff_t* cff_table_get_by_t(cff_table_ctx_t *ctx, int d, int t);
  */
 cff_t* cff_table_get_by_n(cff_table_ctx_t *ctx, int d, int n);
 
+/**
+ * @brief Design a second stage of tests for the items a first stage left ambiguous.
+ *
+ * The outcomes of the tests of `cff` are decoded as by `cff_decoder_t`: items in a negative test
+ * are negative, and the only item left in a positive test is positive. If `p` items were confirmed
+ * positive, at most `d - p` of the other items that were not ruled out are positive, so with
+ * `p < d` these `m` items are ambiguous (with `p >= d` they are all negative). The second stage is
+ * a `min(d - p, m - 1)`-CFF on the ambiguous items: the best one in the tables with its extra
+ * columns removed, or one test per item if that is smaller. A single ambiguous item gets a single
+ * test, as a 0-CFF(1, 1).
+ *
+ * After the negative tests are applied to a bitmap of the columns, the work is proportional to
+ * the number of items left times the number of positive tests.
+ *
+ * @param ctx The CFF tables to draw the design from. May be NULL to only use individual tests.
+ * @param cff The CFF whose rows are the first stage tests.
+ * @param outcomes The packed outcome vector of the first stage.
+ * @param d The largest number of positive items expected, which may be larger than the `d` of
+ * `cff` (with at most `cff`'s `d` positive items nothing is ambiguous).
+ * @param budget The largest number of tests allowed in the second stage.
+ * @param[out] items Receives the ambiguous items (columns of `cff`) in increasing order. Column
+ * `j` of the returned design tests item `items[j]`.
+ * @param max_items The length of the `items` array.
+ * @param[out] num_items Receives the number of ambiguous items, or -1 on error.
+ *
+ * @return The second stage design, or NULL if no items are ambiguous, `max_items` is smaller than
+ * `*num_items` (call again with a larger array), the design would need more than `budget` tests,
+ * or on error.
+ *
+ * @note A user has ownership of the returned CFF and must free it themselves with `cff_free()`.
+ */
+cff_t* cff_follow_up_design(cff_table_ctx_t *ctx, const cff_t *cff, const unsigned char *outcomes,
+                            int d, int budget, long long *items, long long max_items, long long *num_items);
+
 /**
  * @brief Write the contents of the tables to CSV files.
  *
@@ -403,6 +1121,41 @@ cff_t* cff_table_get_by_n(cff_table_ctx_t *ctx, int d, int n);
  * @pre `folder_path` is an existing folder in the file system.
  */
 void cff_table_write_csv(cff_table_ctx_t *ctx, const char *folder_path);
+
+/**
+ * @brief Save the tables to a binary file, to be loaded later with `cff_table_load()`.
+ *
+ * The file holds the rows of every table along with the bounds the tables were created with and
+ * the version of the library, and a checksum of the rows. An existing file at `path` is replaced.
+ *
+ * @param ctx The `cff_table_ctx_t` to save.
+ * @param path The path of the file to write.
+ *
+ * @return 0 on success, or -1 if the file could not be written.
+ */
+int cff_table_save(const cff_table_ctx_t *ctx, const char *path);
+
+/**
+ * @brief Load tables saved with `cff_table_save()` instead of creating them.
+ *
+ * The file is only used if it was saved from tables created with the same bounds by the same
+ * version of the library, and its checksum matches; then the result is the same as
+ * `cff_table_create(d_maximum, t_maximum, n_maximum)`, without building anything. Each process
+ * reads the file into its own tables, since growing them (`cff_table_extend()`) and constructing
+ * CFFs from them write to them.
+ *
+ * A typical use is to try `cff_table_load()` first, and on NULL create the tables and save them
+ * for the next time.
+ *
+ * @param path The path of the file to read.
+ * @param d_maximum The maximum `d` that will appear in the tables.
+ * @param t_maximum The maximum `t` that will appear in the tables.
+ * @param n_maximum The maximum `n` that will appear in the tables.
+ *
+ * @return The loaded tables, to be freed with `cff_table_free()`, or NULL if the file cannot be
+ * read, was saved for other bounds or another version of the library, or is damaged.
+ */
+cff_table_ctx_t* cff_table_load(const char *path, int d_maximum, int t_maximum, long long n_maximum);
 /** @} */ // end of tables group
 
 /* ============================================================================
@@ -7,10 +7,6 @@
 
 #include "cff_internals.h"
 
-// if true, when running cff_verify(), it will print out which rows in
-// the CFF the d+1 rows of the ID matrix are found on
-#define CFF_VERIFY_VERBOSE_PRINTOUT false
-
 // allocates a d-CFF(t,n) filled with 0s
 cff_t* cff_alloc(int d, int t, long long n)
 {
@@ -22,13 +18,19 @@ cff_t* cff_alloc(int d, int t, long long n)
     c->stride_bits = (long long) (((n + 7) / 8) * 8);
     c->matrix = calloc(((n + 7) / 8) * t, sizeof(unsigned char));
     if (c->matrix == NULL) return NULL;
+    c->recipe = NULL;
+    c->matrix_checksum = 0;
     return c;
 }
 
 // free a CFF from memory
 void cff_free(cff_t *cff)
 {
-    if (cff!=NULL) free(cff->matrix);
+    if (cff!=NULL)
+    {
+        free(cff->matrix);
+        cff_recipe_free(cff->recipe);
+    }
     free(cff);
 }
 
@@ -139,6 +141,10 @@ cff_t* cff_copy(const cff_t *src)
             );
         }
     }
+    // the copy keeps the source's recipe and checksum, so it can only be certified
+    // by construction if the copied cells are identical to the constructed ones
+    cff->recipe = cff_recipe_copy(src->recipe);
+    cff->matrix_checksum = src->matrix_checksum;
     return cff;
 }
 
@@ -184,84 +190,3 @@ void cff_write(const cff_t *cff, FILE *file)
         fprintf(file, "\n");
     }
 }
-
-
-// returns true if the CFF is a valid cover free family.
-// returns false otherwise.
-bool cff_verify(const cff_t *cff)
-{
-    if (cff->d+1 > cff->n)
-    { // return false if the parameters are invalid
-        return false;
-    }
-
-    // cols will be an array of columns of size d+1 to test
-    int k = cff->d + 1;
-    int cols[k];
-    for (int i = 0; i < k; i++)
-    { // set cols to the smallest lexicographic ordering
-        cols[i] = i;
-    }
-
-    do
-    {
-        if (CFF_VERIFY_VERBOSE_PRINTOUT)
-        { //print out the current columns that are being tested
-            printf("Testing cols:  ");
-            for (int x = 0; x < k; x++)
-            {
-                printf("%u  ", cols[x]);
-            }
-            printf("| ID Matrix found on rows:  ");
-        }
-
-        // verify array "v". keeps track of the first i.d. row for every col in "cols"  array
-        int v[k];
-        for (int x = 0; x < k; x++)
-        {
-            v[x] = -1;
-        }
-
-        // s is sum of the current row, e will be the most recent column where a 1 was seen
-        int s, e;
-        // f is the number of identity rows found so far (for this particular subset of columns)
-        int f = 0;
-        // iterate over the rows in the cff
-        for (int r = 0; r < cff->t; r++)
-        {
-            // iterate over the subset of columns we are currently testing
-            s = 0;
-            for (int c = 0; c < k; c++)
-            {
-                // if the current cell is 1:
-                if (cff_get_matrix_value(cff, r, cols[c]) == 1)
-                { // record the position of the column and increment row sum
-                    e = c;
-                    s++;
-                }
-            }
-            // check if the row was the first identity row for its column with a 1
-            if (s == 1 && v[e] == -1)
-            {
-                if (CFF_VERIFY_VERBOSE_PRINTOUT) { printf("%u  ", r); }
-                // record that c's identity row exists (by saving the row index)
-                v[e] = (int) r;
-                f++;
-                if (f == k)
-                { // exit early if all identity rows are found
-                    break;
-                }
-
-            }
-        }
-
-        // now return false if any of the identity rows were not there
-        if (f != k)
-        {
-            if (CFF_VERIFY_VERBOSE_PRINTOUT) { printf(" Some ID rows not found! CFF is invalid\n"); }
-            return false;
-        }
-        if (CFF_VERIFY_VERBOSE_PRINTOUT) { printf("\n"); }
-    } while (k_subset_lex_successor(cff->n, k, cols));
-    return true;
-}
\ No newline at end of file
@@ -0,0 +1,1143 @@
+#include "../include/libcfftables/libcfftables.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+
+#include "cff_internals.h"
+#include "constructions/construction_internals.h"
+
+/*
+    Group testing decoders.
+
+    Row r of a CFF is a test that pools the items (columns) with a 1 in it,
+    and the outcome of a test is positive when it pools a positive item. The
+    outcomes are packed like the rows of the matrix: bit r % 8 of byte r / 8.
+
+    cff_decode() is the COMP decoder: every item in a negative test is
+    negative, and the items that are left are reported as positive. For a
+    d-CFF with at most d positive items this is exactly the positive set.
+    The candidates are a bitmap over the columns, and each negative row
+    clears its items from it with one AND-NOT per 64 columns, read straight
+    from the row-major matrix, so decoding streams over the negative rows
+    once at memory bandwidth.
+*/
+
+// true if bit r of the packed outcomes is set
+static inline bool outcome_is_positive(const unsigned char *outcomes, int r)
+{
+    return (outcomes[r / 8] >> (r % 8)) & 1;
+}
+
+// clears the items of a row of the matrix from the candidates
+static void eliminate_row(uint64_t *candidates, const unsigned char *row, long long row_bytes)
+{
+    long long full_words = row_bytes / 8;
+    for (long long i = 0; i < full_words; i++)
+    {
+        candidates[i] &= ~load_le64(row + i * 8, 8);
+    }
+    if (row_bytes % 8)
+    {
+        candidates[full_words] &= ~load_le64(row + full_words * 8, (int) (row_bytes % 8));
+    }
+}
+
+// writes the set bits (below n) of a bitmap to positives, returns how many there are
+static long long collect_candidates(const uint64_t *candidates, long long n,
+                                    long long *positives, long long max_positives)
+{
+    long long count = 0;
+    long long words = (n + 63) / 64;
+    for (long long i = 0; i < words; i++)
+    {
+        uint64_t word = candidates[i];
+        if (i == words - 1 && n % 64)
+        { // bits past n
+            word &= ((uint64_t) 1 << (n % 64)) - 1;
+        }
+        while (word)
+        {
+            if (count < max_positives && positives != NULL)
+            {
+                positives[count] = i * 64 + lowest_bit64(word);
+            }
+            count++;
+            word &= word - 1;
+        }
+    }
+    return count;
+}
+
+long long cff_decode(const cff_t *cff, const unsigned char *outcomes,
+                     long long *positives, long long max_positives)
+{
+    if (cff == NULL || outcomes == NULL) return -1;
+    long long row_bytes = cff->stride_bits / 8;
+    long long words = (row_bytes + 7) / 8;
+    uint64_t *candidates = malloc((size_t) (words > 0 ? words : 1) * sizeof(uint64_t));
+    if (candidates == NULL) return -1;
+    for (long long i = 0; i < words; i++)
+    {
+        candidates[i] = ~(uint64_t) 0;
+    }
+    for (int r = 0; r < cff->t; r++)
+    {
+        if (!outcome_is_positive(outcomes, r))
+        {
+            eliminate_row(candidates, cff->matrix + r * row_bytes, row_bytes);
+        }
+    }
+    long long count = collect_candidates(candidates, cff->n, positives, max_positives);
+    free(candidates);
+    return count;
+}
+
+/*
+    Batch decoding.
+
+    The outcome vectors of a batch are bit-sliced: word j of row r holds the
+    outcomes of test r in vectors 64j to 64j+63. An item is positive in a
+    vector when every test it is pooled in is positive there, so each column
+    keeps the AND of the words of its rows, its result in 64 vectors at once.
+    The rows are read once, straight from the row-major matrix as in
+    cff_decode(), and each of their 1s ANDs the row's words into its column.
+*/
+
+int cff_decode_batch(const cff_t *cff, const uint64_t *sliced_outcomes, int batch_size,
+                     long long *positives, long long max_positives_per_vector, long long *counts)
+{
+    if (cff == NULL || sliced_outcomes == NULL || counts == NULL || batch_size < 1) return -1;
+    int W = (batch_size + 63) / 64; // words per row of the sliced outcomes
+    uint64_t *alive = malloc((size_t) (cff->n > 0 ? cff->n : 1) * W * sizeof(uint64_t));
+    if (alive == NULL) return -1;
+    for (long long c = 0; c < cff->n; c++)
+    {
+        for (int j = 0; j < W; j++)
+        {
+            alive[c * W + j] = ~(uint64_t) 0;
+        }
+        if (batch_size % 64)
+        { // lanes past the batch
+            alive[c * W + W - 1] = ((uint64_t) 1 << (batch_size % 64)) - 1;
+        }
+    }
+    long long row_bytes = cff->stride_bits / 8;
+    for (int r = 0; r < cff->t; r++)
+    {
+        const uint64_t *outcome = sliced_outcomes + (long long) r * W;
+        const unsigned char *row = cff->matrix + r * row_bytes;
+        for (long long i = 0; i * 8 < row_bytes; i++)
+        {
+            uint64_t items = load_le64(row + i * 8, row_bytes - i * 8 < 8 ? (int) (row_bytes - i * 8) : 8);
+            while (items)
+            {
+                long long c = i * 64 + lowest_bit64(items);
+                if (c >= cff->n) break;
+                for (int j = 0; j < W; j++)
+                {
+                    alive[c * W + j] &= outcome[j];
+                }
+                items &= items - 1;
+            }
+        }
+    }
+    for (int b = 0; b < batch_size; b++)
+    {
+        counts[b] = 0;
+    }
+    for (long long c = 0; c < cff->n; c++)
+    {
+        for (int j = 0; j < W; j++)
+        {
+            uint64_t lanes = alive[c * W + j];
+            while (lanes)
+            {
+                int b = j * 64 + lowest_bit64(lanes);
+                if (counts[b] < max_positives_per_vector && positives != NULL)
+                {
+                    positives[b * max_positives_per_vector + counts[b]] = c;
+                }
+                counts[b]++;
+                lanes &= lanes - 1;
+            }
+        }
+    }
+    free(alive);
+    return 0;
+}
+
+/*
+    Decoding by construction.
+
+    A CFF from the tables remembers how it was built (its recipe), and the
+    outcomes can be decoded node by node instead of column by column:
+
+      - additive and ext by one products are block diagonal, so each block
+        of rows is decoded on its own and the right columns are shifted.
+      - in a Kronecker product, column (c_r, c_l) is pooled in the tests
+        (tr, sl) with tr a test of c_r and sl a test of c_l. So c_l is
+        positive in row block tr (the copy of the left factor scaled by test
+        tr of the right factor) exactly when that block's tests of c_l are all
+        positive. The left factor is decoded in every block with a positive
+        test, and for each surviving c_l the right factor is decoded on the
+        blocks c_l survived in.
+      - the optimized Kronecker product is a Kronecker product of the inner
+        and outer CFFs whose columns must also be positive in the bottom CFF.
+      - a doubling keeps the columns of its two copies that are positive in
+        the smaller CFF and in the rows below it.
+      - Reed-Solomon, Sperner and STS leaves use their own decoders, other
+        leaves are built (once per call) and decoded with cff_decode(). The
+        fields of the Reed-Solomon leaves are also set up once per call,
+        since a Kronecker product decodes its factors many times.
+
+    Every node gives the same positives as cff_decode() on the CFF it builds,
+    and with few positives only the blocks and candidates they touch are
+    visited, so the work follows the sizes of the factors rather than the
+    product of their numbers of columns.
+*/
+
+typedef struct
+{
+    long long *items;
+    long long count;
+    long long capacity;
+} item_list_t;
+
+// leaves built during one call, so repeated decodes of a factor share them,
+// and the fields of the Reed-Solomon leaves by (p, e)
+typedef struct
+{
+    const cff_recipe_t **nodes;
+    cff_t **cffs;
+    int count;
+    finite_field_t **fields;
+    int (*field_keys)[2];
+    int num_fields;
+} leaf_cache_t;
+
+static bool list_reserve(item_list_t *list, long long extra)
+{
+    if (list->count + extra <= list->capacity) return true;
+    long long capacity = list->capacity > 0 ? list->capacity * 2 : 16;
+    while (capacity < list->count + extra) capacity *= 2;
+    long long *grown = realloc(list->items, (size_t) capacity * sizeof(long long));
+    if (grown == NULL) return false;
+    list->items = grown;
+    list->capacity = capacity;
+    return true;
+}
+
+static bool list_push(item_list_t *list, long long item)
+{
+    if (!list_reserve(list, 1)) return false;
+    list->items[list->count++] = item;
+    return true;
+}
+
+static bool list_contains(const item_list_t *list, long long item)
+{
+    if (list->count == 0) return false;
+    return bsearch(&item, list->items, list->count, sizeof(long long), cff_compare_long_long) != NULL;
+}
+
+// sorts a list and drops repeated items
+static void list_sort_unique(item_list_t *list)
+{
+    if (list->count == 0) return;
+    qsort(list->items, list->count, sizeof(long long), cff_compare_long_long);
+    long long kept = 1;
+    for (long long i = 1; i < list->count; i++)
+    {
+        if (list->items[i] != list->items[kept - 1])
+        {
+            list->items[kept++] = list->items[i];
+        }
+    }
+    list->count = kept;
+}
+
+// the packed outcomes of rows first to first + length - 1, or NULL if malloc fails
+static unsigned char* slice_outcomes(const unsigned char *outcomes, long long first, long long length,
+                                     bool *any_positive)
+{
+    unsigned char *slice = calloc((size_t) (length + 7) / 8 + 1, 1);
+    if (slice == NULL) return NULL;
+    *any_positive = false;
+    for (long long r = 0; r < length; r++)
+    {
+        long long src = first + r;
+        if ((outcomes[src / 8] >> (src % 8)) & 1)
+        {
+            slice[r / 8] |= 1 << (r % 8);
+            *any_positive = true;
+        }
+    }
+    return slice;
+}
+
+static cff_t* build_leaf(const cff_recipe_t *node)
+{
+    switch (node->constructionID)
+    {
+    case CFF_CONSTRUCTION_ID_IDENTITY_MATRIX:
+        return cff_identity(node->d, node->t);
+    case CFF_CONSTRUCTION_ID_SPERNER:
+        return cff_sperner((int) node->n);
+    case CFF_CONSTRUCTION_ID_STS:
+        return cff_sts(node->t);
+    case CFF_CONSTRUCTION_ID_PORAT_ROTHSCHILD:
+        return cff_porat_rothschild(node->consParams[0], node->consParams[1], node->consParams[2],
+                                    node->consParams[3], node->consParams[4]);
+    case CFF_CONSTRUCTION_ID_FIXED_CFF:
+        return cff_fixed(node->d, node->t);
+    default:
+        return NULL;
+    }
+}
+
+static const cff_t* cached_leaf(const cff_recipe_t *node, leaf_cache_t *cache)
+{
+    for (int i = 0; i < cache->count; i++)
+    {
+        if (cache->nodes[i] == node) return cache->cffs[i];
+    }
+    cff_t *leaf = build_leaf(node);
+    if (leaf == NULL) return NULL;
+    const cff_recipe_t **nodes = realloc(cache->nodes, (cache->count + 1) * sizeof(cff_recipe_t *));
+    if (nodes == NULL)
+    {
+        cff_free(leaf);
+        return NULL;
+    }
+    cache->nodes = nodes;
+    cff_t **cffs = realloc(cache->cffs, (cache->count + 1) * sizeof(cff_t *));
+    if (cffs == NULL)
+    {
+        cff_free(leaf);
+        return NULL;
+    }
+    cache->cffs = cffs;
+    cache->nodes[cache->count] = node;
+    cache->cffs[cache->count] = leaf;
+    cache->count++;
+    return leaf;
+}
+
+static const finite_field_t* cached_field(int p, int e, leaf_cache_t *cache)
+{
+    for (int i = 0; i < cache->num_fields; i++)
+    {
+        if (cache->field_keys[i][0] == p && cache->field_keys[i][1] == e) return cache->fields[i];
+    }
+    finite_field_t *field = finite_field_create(p, e);
+    if (field == NULL) return NULL;
+    finite_field_t **fields = realloc(cache->fields, (cache->num_fields + 1) * sizeof(finite_field_t *));
+    if (fields == NULL)
+    {
+        finite_field_free(field);
+        return NULL;
+    }
+    cache->fields = fields;
+    int (*keys)[2] = realloc(cache->field_keys, (cache->num_fields + 1) * sizeof(*keys));
+    if (keys == NULL)
+    {
+        finite_field_free(field);
+        return NULL;
+    }
+    cache->field_keys = keys;
+    cache->fields[cache->num_fields] = field;
+    cache->field_keys[cache->num_fields][0] = p;
+    cache->field_keys[cache->num_fields][1] = e;
+    cache->num_fields++;
+    return field;
+}
+
+static long long decode_leaf(const cff_recipe_t *node, const unsigned char *outcomes, leaf_cache_t *cache,
+                             long long *positives, long long max_positives)
+{
+    const short *params = node->consParams;
+    switch (node->constructionID)
+    {
+    case CFF_CONSTRUCTION_ID_REED_SOLOMON:
+    case CFF_CONSTRUCTION_ID_SHORT_REED_SOLOMON: {
+        const finite_field_t *field = cached_field(params[0], params[1], cache);
+        if (field == NULL) return -1;
+        int s = node->constructionID == CFF_CONSTRUCTION_ID_REED_SOLOMON ? 0 : params[4];
+        return reed_solomon_list_decode(field, params[2], params[3], s, outcomes, positives, max_positives);
+    }
+    case CFF_CONSTRUCTION_ID_SPERNER:
+        return cff_sperner_decode((int) node->n, outcomes, positives, max_positives);
+    case CFF_CONSTRUCTION_ID_STS:
+        return cff_sts_decode(node->t, outcomes, positives, max_positives);
+    default: {
+        const cff_t *leaf = cached_leaf(node, cache);
+        if (leaf == NULL) return -1;
+        return cff_decode(leaf, outcomes, positives, max_positives);
+    }
+    }
+}
+
+static bool decode_node(const cff_recipe_t *node, const unsigned char *outcomes, leaf_cache_t *cache,
+                        item_list_t *out);
+
+// appends the positives of a leaf, retrying once with the exact count if they did not fit
+static bool decode_leaf_into(const cff_recipe_t *node, const unsigned char *outcomes, leaf_cache_t *cache,
+                             item_list_t *out)
+{
+    long long space = 64;
+    for (;;)
+    {
+        if (!list_reserve(out, space)) return false;
+        long long count = decode_leaf(node, outcomes, cache, out->items + out->count, space);
+        if (count < 0) return false;
+        if (count <= space)
+        {
+            out->count += count;
+            return true;
+        }
+        space = count;
+    }
+}
+
+// decodes rows first to first + node->t - 1 of the outcomes with node, shifting the positives by offset
+static bool decode_block(const cff_recipe_t *node, const unsigned char *outcomes, long long first,
+                         long long offset, leaf_cache_t *cache, item_list_t *out)
+{
+    bool any_positive;
+    unsigned char *slice = slice_outcomes(outcomes, first, node->t, &any_positive);
+    if (slice == NULL) return false;
+    item_list_t block = {0};
+    bool ok = decode_node(node, slice, cache, &block);
+    free(slice);
+    for (long long i = 0; ok && i < block.count; i++)
+    {
+        ok = list_push(out, block.items[i] + offset);
+    }
+    free(block.items);
+    return ok;
+}
+
+// the Kronecker product of left and right on rows 0 to left->t * right->t - 1 of the outcomes
+static bool decode_kronecker(const cff_recipe_t *left, const cff_recipe_t *right, const unsigned char *outcomes,
+                             leaf_cache_t *cache, item_list_t *out)
+{
+    int rt = right->t;
+    item_list_t *blocks = calloc(rt, sizeof(item_list_t));
+    bool *uses_zero = calloc(rt, sizeof(bool)); // blocks without a positive test share one decode
+    unsigned char *aggregated = calloc((size_t) (rt + 7) / 8, 1);
+    unsigned char *zero = calloc((size_t) (left->t > rt ? left->t : rt) / 8 + 1, 1);
+    item_list_t zero_left = {0}, zero_right = {0}, survivors = {0}, positives = {0};
+    bool ok = blocks != NULL && uses_zero != NULL && aggregated != NULL && zero != NULL;
+    bool have_zero_left = false;
+
+    // decode the left factor in every row block
+    for (int tr = 0; ok && tr < rt; tr++)
+    {
+        bool any_positive;
+        unsigned char *slice = slice_outcomes(outcomes, (long long) tr * left->t, left->t, &any_positive);
+        if (slice == NULL)
+        {
+            ok = false;
+            break;
+        }
+        if (any_positive)
+        {
+            ok = decode_node(left, slice, cache, &blocks[tr]);
+        } else
+        {
+            uses_zero[tr] = true;
+            if (!have_zero_left)
+            {
+                ok = decode_node(left, zero, cache, &zero_left);
+                have_zero_left = true;
+            }
+        }
+        free(slice);
+    }
+
+    // every left column that survived some block is a candidate
+    for (int tr = 0; ok && tr < rt; tr++)
+    {
+        const item_list_t *block = uses_zero[tr] ? &zero_left : &blocks[tr];
+        ok = list_reserve(&survivors, block->count);
+        for (long long i = 0; ok && i < block->count; i++)
+        {
+            survivors.items[survivors.count++] = block->items[i];
+        }
+    }
+    if (ok) list_sort_unique(&survivors);
+
+    // decode the right factor on the blocks each candidate survived in
+    for (long long i = 0; ok && i < survivors.count; i++)
+    {
+        long long c_l = survivors.items[i];
+        memset(aggregated, 0, (size_t) (rt + 7) / 8);
+        for (int tr = 0; tr < rt; tr++)
+        {
+            if (list_contains(uses_zero[tr] ? &zero_left : &blocks[tr], c_l))
+            {
+                aggregated[tr / 8] |= 1 << (tr % 8);
+            }
+        }
+        positives.count = 0;
+        ok = decode_node(right, aggregated, cache, &positives);
+        for (long long j = 0; ok && j < positives.count; j++)
+        {
+            ok = list_push(out, positives.items[j] * left->n + c_l);
+        }
+    }
+
+    // a right column in no test is positive with every left column, even those that survived nowhere
+    if (ok) ok = decode_node(right, zero, cache, &zero_right);
+    for (long long j = 0; ok && j < zero_right.count; j++)
+    {
+        for (long long c_l = 0; ok && c_l < left->n; c_l++)
+        {
+            if (!list_contains(&survivors, c_l))
+            {
+                ok = list_push(out, zero_right.items[j] * left->n + c_l);
+            }
+        }
+    }
+
+    for (int tr = 0; blocks != NULL && tr < rt; tr++)
+    {
+        free(blocks[tr].items);
+    }
+    free(blocks);
+    free(uses_zero);
+    free(aggregated);
+    free(zero);
+    free(zero_left.items);
+    free(zero_right.items);
+    free(survivors.items);
+    free(positives.items);
+    return ok;
+}
+
+static bool decode_optimized_kronecker(const cff_recipe_t *node, const unsigned char *outcomes,
+                                       leaf_cache_t *cache, item_list_t *out)
+{
+    const cff_recipe_t *outer = node->children[0];
+    const cff_recipe_t *inner = node->children[1];
+    const cff_recipe_t *bottom = node->children[2];
+    item_list_t top = {0}, below = {0};
+    bool ok = decode_block(bottom, outcomes, (long long) outer->t * inner->t, 0, cache, &below);
+    if (ok && below.count > 0)
+    {
+        list_sort_unique(&below);
+        ok = decode_kronecker(inner, outer, outcomes, cache, &top);
+    }
+    for (long long i = 0; ok && i < top.count; i++)
+    {
+        long long n1 = top.items[i] / inner->n;
+        if (n1 < bottom->n && list_contains(&below, n1))
+        {
+            ok = list_push(out, top.items[i]);
+        }
+    }
+    free(top.items);
+    free(below.items);
+    return ok;
+}
+
+static bool decode_doubling(const cff_recipe_t *node, const unsigned char *outcomes,
+                            leaf_cache_t *cache, item_list_t *out)
+{
+    const cff_recipe_t *child = node->children[0];
+    int s = node->consParams[1];
+    int half = (s + 1) / 2;
+    int subset[half > 0 ? half : 1];
+    item_list_t copies = {0};
+    bool ok = decode_block(child, outcomes, 0, 0, cache, &copies);
+    for (long long i = 0; ok && i < copies.count; i++)
+    {
+        long long c = copies.items[i];
+        // column c has the rows of the c-th half-subset of the s middle rows, column c + n the others
+        k_subset_lex_unrank(s, half, c, subset);
+        bool first_copy = true, second_copy = true;
+        for (int row = 0, j = 0; row < s; row++)
+        {
+            bool in_subset = j < half && subset[j] == row;
+            if (in_subset) j++;
+            bool positive = outcome_is_positive(outcomes, child->t + row);
+            if (in_subset) first_copy &= positive;
+            else second_copy &= positive;
+        }
+        // the rows at the bottom tell the two copies apart
+        int bottom = child->t + s;
+        if (s % 2 == 1)
+        {
+            second_copy &= outcome_is_positive(outcomes, bottom);
+        } else
+        {
+            first_copy &= outcome_is_positive(outcomes, bottom);
+            second_copy &= outcome_is_positive(outcomes, bottom + 1);
+        }
+        if (first_copy) ok = list_push(out, c);
+        if (ok && second_copy) ok = list_push(out, c + child->n);
+    }
+    free(copies.items);
+    return ok;
+}
+
+// appends the positives of the CFF built by node to out, in increasing order
+static bool decode_node(const cff_recipe_t *node, const unsigned char *outcomes, leaf_cache_t *cache,
+                        item_list_t *out)
+{
+    item_list_t found = {0};
+    bool ok;
+    switch (node->constructionID)
+    {
+    case CFF_CONSTRUCTION_ID_EXT_BY_ONE: {
+        const cff_recipe_t *child = node->children[0];
+        ok = decode_block(child, outcomes, 0, 0, cache, &found);
+        if (ok && outcome_is_positive(outcomes, child->t))
+        {
+            ok = list_push(&found, child->n);
+        }
+        break;
+    }
+    case CFF_CONSTRUCTION_ID_ADDITIVE: {
+        const cff_recipe_t *left = node->children[0];
+        const cff_recipe_t *right = node->children[1];
+        ok = decode_block(left, outcomes, 0, 0, cache, &found)
+            && decode_block(right, outcomes, left->t, left->n, cache, &found);
+        break;
+    }
+    case CFF_CONSTRUCTION_ID_DOUBLING:
+        ok = decode_doubling(node, outcomes, cache, &found);
+        break;
+    case CFF_CONSTRUCTION_ID_KRONECKER:
+        ok = decode_kronecker(node->children[0], node->children[1], outcomes, cache, &found);
+        break;
+    case CFF_CONSTRUCTION_ID_OPTIMIZED_KRONECKER:
+        ok = decode_optimized_kronecker(node, outcomes, cache, &found);
+        break;
+    default:
+        ok = decode_leaf_into(node, outcomes, cache, &found);
+        break;
+    }
+    if (ok)
+    {
+        list_sort_unique(&found);
+        ok = list_reserve(out, found.count);
+        for (long long i = 0; ok && i < found.count; i++)
+        {
+            out->items[out->count++] = found.items[i];
+        }
+    }
+    free(found.items);
+    return ok;
+}
+
+long long cff_decode_by_construction(const cff_t *cff, const unsigned char *outcomes,
+                                     long long *positives, long long max_positives)
+{
+    if (cff == NULL || outcomes == NULL) return -1;
+    const cff_recipe_t *recipe = cff->recipe;
+    if (recipe == NULL || recipe->t != cff->t || recipe->n != cff->n)
+    { // not from the tables, or resized since
+        return cff_decode(cff, outcomes, positives, max_positives);
+    }
+    leaf_cache_t cache = {0};
+    item_list_t found = {0};
+    bool ok = decode_node(recipe, outcomes, &cache, &found);
+    for (int i = 0; i < cache.count; i++)
+    {
+        cff_free(cache.cffs[i]);
+    }
+    free(cache.nodes);
+    free(cache.cffs);
+    for (int i = 0; i < cache.num_fields; i++)
+    {
+        finite_field_free(cache.fields[i]);
+    }
+    free(cache.fields);
+    free(cache.field_keys);
+    if (!ok)
+    {
+        free(found.items);
+        return -1;
+    }
+    for (long long i = 0; i < found.count && i < max_positives && positives != NULL; i++)
+    {
+        positives[i] = found.items[i];
+    }
+    long long count = found.count;
+    free(found.items);
+    return count;
+}
+
+/*
+    Streaming decoding.
+
+    A cff_decoder_t takes the outcomes one test at a time, in any order. The
+    candidates start as every item, and a negative test clears its items
+    from them straight away with the same AND-NOT as cff_decode(), so once
+    every test is in the candidates are the result of cff_decode(). Items
+    no longer candidates are confirmed negative. A positive test pools at
+    least one positive item, so when it has a single candidate left that
+    candidate is confirmed positive; this is checked against the positive
+    tests received so far whenever the items are asked for.
+*/
+
+struct cff_decoder
+{
+    const cff_t *cff;
+    long long words; // words per bitmap of items
+    uint64_t *candidates;
+    unsigned char *received; // bit per test
+    int *positive_tests;
+    int num_positive_tests;
+    int num_received;
+};
+
+cff_decoder_t* cff_decoder_create(const cff_t *cff)
+{
+    if (cff == NULL) return NULL;
+    cff_decoder_t *dec = malloc(sizeof(cff_decoder_t));
+    if (dec == NULL) return NULL;
+    dec->cff = cff;
+    dec->words = (cff->stride_bits / 8 + 7) / 8;
+    dec->candidates = malloc((size_t) (dec->words > 0 ? dec->words : 1) * sizeof(uint64_t));
+    dec->received = calloc((size_t) (cff->t + 7) / 8 + 1, 1);
+    dec->positive_tests = malloc((size_t) (cff->t > 0 ? cff->t : 1) * sizeof(int));
+    if (dec->candidates == NULL || dec->received == NULL || dec->positive_tests == NULL)
+    {
+        cff_decoder_free(dec);
+        return NULL;
+    }
+    for (long long i = 0; i < dec->words; i++)
+    {
+        dec->candidates[i] = ~(uint64_t) 0;
+    }
+    dec->num_positive_tests = 0;
+    dec->num_received = 0;
+    return dec;
+}
+
+void cff_decoder_free(cff_decoder_t *dec)
+{
+    if (dec == NULL) return;
+    free(dec->candidates);
+    free(dec->received);
+    free(dec->positive_tests);
+    free(dec);
+}
+
+int cff_decoder_add_outcome(cff_decoder_t *dec, int test, bool positive)
+{
+    if (dec == NULL || test < 0 || test >= dec->cff->t) return -1;
+    if (outcome_is_positive(dec->received, test)) return -1; // already in
+    dec->received[test / 8] |= 1 << (test % 8);
+    dec->num_received++;
+    long long row_bytes = dec->cff->stride_bits / 8;
+    if (positive)
+    {
+        dec->positive_tests[dec->num_positive_tests++] = test;
+    } else
+    {
+        eliminate_row(dec->candidates, dec->cff->matrix + test * row_bytes, row_bytes);
+    }
+    return 0;
+}
+
+int cff_decoder_get_num_outcomes(const cff_decoder_t *dec)
+{
+    if (dec == NULL) return -1;
+    return dec->num_received;
+}
+
+// the candidates that are alone among the candidates of some positive test
+static uint64_t* confirmed_positives(const cff_decoder_t *dec)
+{
+    uint64_t *confirmed = calloc((size_t) (dec->words > 0 ? dec->words : 1), sizeof(uint64_t));
+    if (confirmed == NULL) return NULL;
+    long long row_bytes = dec->cff->stride_bits / 8;
+    long long n = dec->cff->n;
+    for (int i = 0; i < dec->num_positive_tests; i++)
+    {
+        const unsigned char *row = dec->cff->matrix + dec->positive_tests[i] * row_bytes;
+        long long single = -1;
+        bool several = false;
+        for (long long w = 0; w < dec->words && !several; w++)
+        {
+            long long bytes = row_bytes - w * 8 < 8 ? row_bytes - w * 8 : 8;
+            uint64_t left = dec->candidates[w] & load_le64(row + w * 8, (int) bytes);
+            if (w == dec->words - 1 && n % 64)
+            { // bits past n
+                left &= ((uint64_t) 1 << (n % 64)) - 1;
+            }
+            if (left == 0) continue;
+            if (single != -1 || (left & (left - 1)) != 0)
+            {
+                several = true;
+            } else
+            {
+                single = w * 64 + lowest_bit64(left);
+            }
+        }
+        if (!several && single != -1)
+        {
+            confirmed[single / 64] |= (uint64_t) 1 << (single % 64);
+        }
+    }
+    return confirmed;
+}
+
+long long cff_decoder_get_items(const cff_decoder_t *dec, cff_item_status_t status,
+                                long long *items, long long max_items)
+{
+    if (dec == NULL) return -1;
+    if (status != CFF_ITEM_NEGATIVE && status != CFF_ITEM_POSITIVE && status != CFF_ITEM_AMBIGUOUS) return -1;
+    uint64_t *selected = malloc((size_t) (dec->words > 0 ? dec->words : 1) * sizeof(uint64_t));
+    uint64_t *confirmed = confirmed_positives(dec);
+    if (selected == NULL || confirmed == NULL)
+    {
+        free(selected);
+        free(confirmed);
+        return -1;
+    }
+    for (long long i = 0; i < dec->words; i++)
+    {
+        switch (status)
+        {
+        case CFF_ITEM_NEGATIVE:
+            selected[i] = ~dec->candidates[i];
+            break;
+        case CFF_ITEM_POSITIVE:
+            selected[i] = confirmed[i];
+            break;
+        default:
+            selected[i] = dec->candidates[i] & ~confirmed[i];
+            break;
+        }
+    }
+    long long count = collect_candidates(selected, dec->cff->n, items, max_items);
+    free(selected);
+    free(confirmed);
+    return count;
+}
+
+/*
+    Threshold decoding.
+
+    With noisy tests a positive item can land in a negative test, and COMP
+    would drop it. Instead each item gets the fraction of its tests that came
+    back positive. The rows are read once, straight from the row-major matrix
+    as in cff_decode(), and every 64 columns of a row are added to bit-sliced
+    counters of positive or of negative tests (one word per bit of the count,
+    with a carry that rarely goes past the first word), so no copy of the
+    matrix is made. The items at or above a threshold are reported, or the k
+    best ones. An item in no test has no evidence and scores 0.
+*/
+
+// adds the columns of a row of the matrix to a bit-sliced counter: bit b of the count of column c
+// is bit c % 64 of counter[(c / 64) * planes + b]
+static void count_row(uint64_t *counter, int planes, const unsigned char *row, long long row_bytes)
+{
+    for (long long i = 0; i * 8 < row_bytes; i++)
+    {
+        uint64_t carry = load_le64(row + i * 8, row_bytes - i * 8 < 8 ? (int) (row_bytes - i * 8) : 8);
+        uint64_t *count = counter + i * planes;
+        for (int b = 0; b < planes && carry; b++)
+        {
+            uint64_t sum = count[b] ^ carry;
+            carry &= count[b];
+            count[b] = sum;
+        }
+    }
+}
+
+// the count of column c in a bit-sliced counter
+static int counted(const uint64_t *counter, int planes, long long c)
+{
+    const uint64_t *count = counter + (c / 64) * planes;
+    int value = 0;
+    for (int b = 0; b < planes; b++)
+    {
+        value |= (int) ((count[b] >> (c % 64)) & 1) << b;
+    }
+    return value;
+}
+
+// the number of positive tests (hits) and of tests (weights) of each column
+static bool score_columns(const cff_t *cff, const unsigned char *outcomes, int *hits, int *weights)
+{
+    long long row_bytes = cff->stride_bits / 8;
+    long long words = (row_bytes + 7) / 8;
+    int planes = 1;
+    while (planes < 31 && (1LL << planes) <= cff->t) planes++;
+    uint64_t *positive = calloc((size_t) (words > 0 ? words : 1) * planes, sizeof(uint64_t));
+    uint64_t *negative = calloc((size_t) (words > 0 ? words : 1) * planes, sizeof(uint64_t));
+    if (positive == NULL || negative == NULL)
+    {
+        free(positive);
+        free(negative);
+        return false;
+    }
+    for (int r = 0; r < cff->t; r++)
+    {
+        count_row(outcome_is_positive(outcomes, r) ? positive : negative, planes,
+                  cff->matrix + r * row_bytes, row_bytes);
+    }
+    for (long long c = 0; c < cff->n; c++)
+    {
+        hits[c] = counted(positive, planes, c);
+        weights[c] = hits[c] + counted(negative, planes, c);
+    }
+    free(positive);
+    free(negative);
+    return true;
+}
+
+long long cff_decode_threshold(const cff_t *cff, const unsigned char *outcomes, double threshold,
+                               long long *positives, long long max_positives)
+{
+    if (cff == NULL || outcomes == NULL) return -1;
+    int *hits = malloc((size_t) (cff->n > 0 ? cff->n : 1) * sizeof(int));
+    int *weights = malloc((size_t) (cff->n > 0 ? cff->n : 1) * sizeof(int));
+    if (hits == NULL || weights == NULL || !score_columns(cff, outcomes, hits, weights))
+    {
+        free(hits);
+        free(weights);
+        return -1;
+    }
+    long long count = 0;
+    for (long long c = 0; c < cff->n; c++)
+    {
+        if (weights[c] > 0 && hits[c] >= threshold * weights[c])
+        {
+            if (count < max_positives && positives != NULL)
+            {
+                positives[count] = c;
+            }
+            count++;
+        }
+    }
+    free(hits);
+    free(weights);
+    return count;
+}
+
+// true if column a ranks before column b: a higher score, then more hits, then a lower index
+static bool ranks_before(const int *hits, const int *weights, long long a, long long b)
+{
+    // compare hits[a] / weights[a] with hits[b] / weights[b] without dividing (empty columns score 0)
+    long long left = weights[a] > 0 ? (long long) hits[a] * (weights[b] > 0 ? weights[b] : 1) : 0;
+    long long right = weights[b] > 0 ? (long long) hits[b] * (weights[a] > 0 ? weights[a] : 1) : 0;
+    if (left != right) return left > right;
+    if (hits[a] != hits[b]) return hits[a] > hits[b];
+    return a < b;
+}
+
+// restores the heap property below position i of a heap whose root is the worst column kept
+static void sift_down(long long *heap, long long size, long long i, const int *hits, const int *weights)
+{
+    for (;;)
+    {
+        long long worst = i, l = 2 * i + 1, r = 2 * i + 2;
+        if (l < size && ranks_before(hits, weights, heap[worst], heap[l])) worst = l;
+        if (r < size && ranks_before(hits, weights, heap[worst], heap[r])) worst = r;
+        if (worst == i) return;
+        long long swap = heap[i];
+        heap[i] = heap[worst];
+        heap[worst] = swap;
+        i = worst;
+    }
+}
+
+long long cff_decode_top_k(const cff_t *cff, const unsigned char *outcomes, long long k,
+                           long long *items, double *scores)
+{
+    if (cff == NULL || outcomes == NULL || items == NULL || k < 0) return -1;
+    if (k > cff->n) k = cff->n;
+    int *hits = malloc((size_t) (cff->n > 0 ? cff->n : 1) * sizeof(int));
+    int *weights = malloc((size_t) (cff->n > 0 ? cff->n : 1) * sizeof(int));
+    if (hits == NULL || weights == NULL || !score_columns(cff, outcomes, hits, weights))
+    {
+        free(hits);
+        free(weights);
+        return -1;
+    }
+    // keep the k best columns in items, as a heap with the worst of them at the root
+    long long size = 0;
+    for (long long c = 0; c < cff->n && k > 0; c++)
+    {
+        if (size < k)
+        {
+            items[size++] = c;
+            if (size == k)
+            {
+                for (long long i = k / 2 - 1; i >= 0; i--) sift_down(items, size, i, hits, weights);
+            }
+        } else if (ranks_before(hits, weights, c, items[0]))
+        {
+            items[0] = c;
+            sift_down(items, size, 0, hits, weights);
+        }
+    }
+    // heap sort: moving the worst to the end leaves the best first
+    for (long long end = size - 1; end > 0; end--)
+    {
+        long long swap = items[0];
+        items[0] = items[end];
+        items[end] = swap;
+        sift_down(items, end, 0, hits, weights);
+    }
+    for (long long i = 0; i < size && scores != NULL; i++)
+    {
+        long long c = items[i];
+        scores[i] = weights[c] > 0 ? (double) hits[c] / weights[c] : 0.0;
+    }
+    free(hits);
+    free(weights);
+    return size;
+}
+
+/*
+    Follow-up designs.
+
+    After a round of tests, the items that are neither negative nor
+    confirmed positive (see cff_decoder_t) need a second round. The
+    negative tests clear their items from a bitmap of candidates as in
+    cff_decode(), and from there the work is on the k candidates only: each
+    candidate's cells in the positive tests are read directly to count the
+    candidates of every positive test, so a test left with one candidate
+    confirms it in O(k) per positive test instead of a pass over its row.
+    With at most d positive items and p of them confirmed, at most d - p are
+    among the m ambiguous ones, so a (d - p)-CFF on m items (at most an
+    (m - 1)-CFF, a single item takes a 0-CFF(1, 1)) resolves them:
+    the one with the fewest tests out of the tables (cut down to m columns)
+    or m individual tests, whichever is smaller.
+*/
+
+// the candidates left by the negative tests, in increasing order, and the positive tests; NULL if
+// out of memory
+static long long* follow_up_candidates(const cff_t *cff, const unsigned char *outcomes, long long *num_candidates,
+                                       int *positive_tests, int *num_positive_tests)
+{
+    long long row_bytes = cff->stride_bits / 8;
+    long long words = (row_bytes + 7) / 8;
+    uint64_t *candidates = malloc((size_t) (words > 0 ? words : 1) * sizeof(uint64_t));
+    if (candidates == NULL) return NULL;
+    for (long long i = 0; i < words; i++)
+    {
+        candidates[i] = ~(uint64_t) 0;
+    }
+    *num_positive_tests = 0;
+    for (int r = 0; r < cff->t; r++)
+    {
+        if (outcome_is_positive(outcomes, r))
+        {
+            positive_tests[(*num_positive_tests)++] = r;
+        } else
+        {
+            eliminate_row(candidates, cff->matrix + r * row_bytes, row_bytes);
+        }
+    }
+    long long k = collect_candidates(candidates, cff->n, NULL, 0);
+    long long *items = malloc((size_t) (k > 0 ? k : 1) * sizeof(long long));
+    if (items != NULL)
+    {
+        collect_candidates(candidates, cff->n, items, k);
+        *num_candidates = k;
+    }
+    free(candidates);
+    return items;
+}
+
+cff_t* cff_follow_up_design(cff_table_ctx_t *ctx, const cff_t *cff, const unsigned char *outcomes,
+                            int d, int budget, long long *items, long long max_items, long long *num_items)
+{
+    if (num_items == NULL) return NULL;
+    *num_items = -1;
+    if (cff == NULL || outcomes == NULL || d < 1) return NULL;
+    int *positive_tests = malloc((size_t) (cff->t > 0 ? cff->t : 1) * sizeof(int));
+    if (positive_tests == NULL) return NULL;
+    int num_positive_tests = 0;
+    long long k = 0;
+    long long *candidates = follow_up_candidates(cff, outcomes, &k, positive_tests, &num_positive_tests);
+    // per positive test, how many candidates it has and the last of them
+    long long *hits = calloc((size_t) (num_positive_tests > 0 ? num_positive_tests : 1), sizeof(long long));
+    long long *last = malloc((size_t) (num_positive_tests > 0 ? num_positive_tests : 1) * sizeof(long long));
+    unsigned char *confirmed = calloc((size_t) (k > 0 ? k : 1), 1);
+    if (candidates == NULL || hits == NULL || last == NULL || confirmed == NULL)
+    {
+        free(positive_tests);
+        free(candidates);
+        free(hits);
+        free(last);
+        free(confirmed);
+        return NULL;
+    }
+    long long row_bytes = cff->stride_bits / 8;
+    for (long long i = 0; i < k; i++)
+    {
+        long long c = candidates[i];
+        for (int j = 0; j < num_positive_tests; j++)
+        {
+            if ((cff->matrix[positive_tests[j] * row_bytes + c / 8] >> (c % 8)) & 1)
+            {
+                hits[j]++;
+                last[j] = i;
+            }
+        }
+    }
+    long long num_confirmed = 0;
+    for (int j = 0; j < num_positive_tests; j++)
+    {
+        if (hits[j] == 1 && !confirmed[last[j]])
+        {
+            confirmed[last[j]] = 1;
+            num_confirmed++;
+        }
+    }
+    // with d or more confirmed positives the other candidates are all negative
+    long long m = num_confirmed < d ? k - num_confirmed : 0;
+    if (m > 0 && m <= max_items && items != NULL)
+    {
+        long long j = 0;
+        for (long long i = 0; i < k; i++)
+        {
+            if (!confirmed[i]) items[j++] = candidates[i];
+        }
+    }
+    free(positive_tests);
+    free(candidates);
+    free(hits);
+    free(last);
+    free(confirmed);
+    *num_items = m;
+    if (m == 0 || m > max_items || items == NULL) return NULL;
+
+    // positives that can still be among the ambiguous items; a single item needs a 0-CFF(1, 1)
+    long long left = d - num_confirmed;
+    if (left > m - 1) left = m - 1;
+    cff_t *design = NULL;
+    if (ctx != NULL && m > 1 && m <= INT_MAX)
+    {
+        design = cff_table_get_by_n(ctx, (int) left, (int) m);
+        if (design != NULL && design->t >= m)
+        { // not better than individual tests
+            cff_free(design);
+            design = NULL;
+        }
+    }
+    if (design == NULL && m <= budget)
+    { // m individual tests, m fits in an int here
+        design = cff_identity((int) left, (int) m);
+    }
+    if (design == NULL) return NULL;
+    if (design->t > budget)
+    {
+        cff_free(design);
+        return NULL;
+    }
+    cff_reduce_n(design, m);
+    return design;
+}
@@ -0,0 +1,337 @@
+#include "../include/libcfftables/libcfftables.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "cff_internals.h"
+
+/*
+    Batch encoding.
+
+    The outcomes of a batch of positive sets are the boolean product of the
+    matrix with the item-by-batch matrix X: row r of the result is the OR of
+    the rows of X of the items in test r. This uses the Method of Four
+    Russians. Byte g of a row of the matrix already holds the cells of
+    columns 8g to 8g+7, so for each such group of 8 items a table of the 256
+    ORs of their rows of X is built (each entry from a smaller one and a
+    single row), and then every test ORs in one table entry per group
+    instead of up to 8 rows. The work is about (n / 8) * (256 + t) word ORs
+    per word of the batch, against up to t * n for item by item.
+
+    The batch is processed in tiles of words so a table stays in cache, and
+    the groups of items are split between threads, each ORing into its own
+    copy of the outcomes which are merged at the end.
+*/
+
+#define ENCODE_TILE_WORDS 32 // words of the batch per table entry, 64KB per table
+
+typedef struct
+{
+    const cff_t *cff;
+    const uint64_t *sliced_items;
+    int W; // words per row of the sliced matrices
+    long long group_begin; // groups of 8 items handled by this thread
+    long long group_end;
+    uint64_t *outcomes; // t * W words, zeroed
+    bool ok;
+} encode_job_t;
+
+static void* encode_groups(void *arg)
+{
+    encode_job_t *job = arg;
+    const cff_t *cff = job->cff;
+    int W = job->W;
+    long long row_bytes = cff->stride_bits / 8;
+    uint64_t *table = malloc(256 * ENCODE_TILE_WORDS * sizeof(uint64_t));
+    if (table == NULL)
+    {
+        job->ok = false;
+        return NULL;
+    }
+    for (int w0 = 0; w0 < W; w0 += ENCODE_TILE_WORDS)
+    {
+        int tw = W - w0 < ENCODE_TILE_WORDS ? W - w0 : ENCODE_TILE_WORDS;
+        for (long long g = job->group_begin; g < job->group_end; g++)
+        {
+            // table[mask] = OR of the rows of the items of the group in mask
+            memset(table, 0, tw * sizeof(uint64_t));
+            for (int mask = 1; mask < 256; mask++)
+            {
+                uint64_t *entry = table + mask * tw;
+                const uint64_t *smaller = table + (mask & (mask - 1)) * tw;
+                long long c = g * 8 + lowest_bit64(mask);
+                if (c < cff->n)
+                {
+                    const uint64_t *item = job->sliced_items + c * W + w0;
+                    for (int j = 0; j < tw; j++)
+                    {
+                        entry[j] = smaller[j] | item[j];
+                    }
+                } else
+                { // bits past n (e.g. after cff_reduce_n()) pool nothing
+                    memcpy(entry, smaller, tw * sizeof(uint64_t));
+                }
+            }
+            for (int r = 0; r < cff->t; r++)
+            {
+                unsigned char cells = cff->matrix[r * row_bytes + g];
+                if (cells == 0) continue;
+                const uint64_t *entry = table + cells * tw;
+                uint64_t *out = job->outcomes + (long long) r * W + w0;
+                for (int j = 0; j < tw; j++)
+                {
+                    out[j] |= entry[j];
+                }
+            }
+        }
+    }
+    free(table);
+    return NULL;
+}
+
+int cff_encode_batch(const cff_t *cff, const uint64_t *sliced_items, int batch_size,
+                     uint64_t *sliced_outcomes, int num_threads)
+{
+    if (cff == NULL || sliced_items == NULL || sliced_outcomes == NULL || batch_size < 1) return -1;
+    int W = (batch_size + 63) / 64;
+    long long out_words = (long long) cff->t * W;
+    memset(sliced_outcomes, 0, (size_t) out_words * sizeof(uint64_t));
+    long long groups = (cff->n + 7) / 8;
+    if (groups == 0) return 0;
+    if (num_threads < 1) num_threads = 1;
+    if (num_threads > groups) num_threads = (int) groups;
+
+    encode_job_t jobs[num_threads];
+    pthread_t threads[num_threads];
+    bool started[num_threads];
+    bool ok = true;
+    for (int i = 0; i < num_threads; i++)
+    {
+        jobs[i].cff = cff;
+        jobs[i].sliced_items = sliced_items;
+        jobs[i].W = W;
+        jobs[i].group_begin = groups * i / num_threads;
+        jobs[i].group_end = groups * (i + 1) / num_threads;
+        jobs[i].ok = true;
+        started[i] = false;
+        // the first job writes the result directly, the others into their own copies
+        jobs[i].outcomes = i == 0 ? sliced_outcomes : calloc((size_t) out_words, sizeof(uint64_t));
+        if (jobs[i].outcomes == NULL) ok = false;
+    }
+    for (int i = 1; ok && i < num_threads; i++)
+    {
+        started[i] = pthread_create(&threads[i], NULL, encode_groups, &jobs[i]) == 0;
+        if (!started[i])
+        { // no thread available, do it here instead
+            encode_groups(&jobs[i]);
+        }
+    }
+    if (ok) encode_groups(&jobs[0]);
+    for (int i = 1; i < num_threads; i++)
+    {
+        if (started[i]) pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; i < num_threads; i++)
+    {
+        ok &= jobs[i].ok;
+    }
+    for (int i = 1; i < num_threads; i++)
+    {
+        if (ok)
+        {
+            for (long long k = 0; k < out_words; k++)
+            {
+                sliced_outcomes[k] |= jobs[i].outcomes[k];
+            }
+        }
+        free(jobs[i].outcomes);
+    }
+    return ok ? 0 : -1;
+}
+
+/*
+    Streaming pool assignment.
+
+    Items arrive one at a time and each is given a column. The item is
+    appended to the pool of every test in the column's support, found from
+    the packed column rather than a pass over the rows. A test's pool is
+    complete once every column in the test has been given an item, and
+    complete pools are handed to the flush callback in batches, so pooling
+    can start before intake ends.
+*/
+
+struct cff_pool_encoder
+{
+    int t;
+    long long n;
+    int w; // words per packed column
+    uint64_t *cols; // packed columns (as in cff_pack_columns())
+    unsigned char *assigned; // bit per column
+    long long *missing; // per test, its columns without an item yet
+    long long **pools; // per test, its items so far (NULL once flushed)
+    long long *pool_sizes;
+    long long *pool_capacities;
+    int *complete; // complete tests waiting to be flushed
+    int num_complete;
+    const long long **batch_pools; // the pools and sizes of the complete tests, for the callback
+    long long *batch_sizes;
+    int batch_size;
+    cff_pool_flush_fn flush;
+    void *user_data;
+};
+
+cff_pool_encoder_t* cff_pool_encoder_create(const cff_t *cff, int batch_size, cff_pool_flush_fn flush,
+                                            void *user_data)
+{
+    if (cff == NULL || flush == NULL || batch_size < 1) return NULL;
+    cff_pool_encoder_t *enc = calloc(1, sizeof(cff_pool_encoder_t));
+    if (enc == NULL) return NULL;
+    enc->t = cff->t;
+    enc->n = cff->n;
+    enc->batch_size = batch_size;
+    enc->flush = flush;
+    enc->user_data = user_data;
+    enc->cols = cff_pack_columns(cff, &enc->w);
+    enc->assigned = calloc((size_t) (cff->n + 7) / 8 + 1, 1);
+    size_t rows = cff->t > 0 ? cff->t : 1;
+    enc->missing = calloc(rows, sizeof(long long));
+    enc->pools = calloc(rows, sizeof(long long *));
+    enc->pool_sizes = calloc(rows, sizeof(long long));
+    enc->pool_capacities = calloc(rows, sizeof(long long));
+    enc->complete = malloc(rows * sizeof(int));
+    enc->batch_pools = malloc(rows * sizeof(long long *));
+    enc->batch_sizes = malloc(rows * sizeof(long long));
+    if (enc->cols == NULL || enc->assigned == NULL || enc->missing == NULL || enc->pools == NULL
+        || enc->pool_sizes == NULL || enc->pool_capacities == NULL || enc->complete == NULL
+        || enc->batch_pools == NULL || enc->batch_sizes == NULL)
+    {
+        cff_pool_encoder_free(enc);
+        return NULL;
+    }
+    for (long long c = 0; c < cff->n; c++)
+    {
+        const uint64_t *col = enc->cols + c * enc->w;
+        for (int i = 0; i < enc->w; i++)
+        {
+            for (uint64_t rows_left = col[i]; rows_left; rows_left &= rows_left - 1)
+            {
+                enc->missing[i * 64 + lowest_bit64(rows_left)]++;
+            }
+        }
+    }
+    for (int r = 0; r < cff->t; r++)
+    {
+        if (enc->missing[r] == 0) enc->pool_capacities[r] = -1; // an empty test has no pool to flush
+    }
+    return enc;
+}
+
+void cff_pool_encoder_free(cff_pool_encoder_t *enc)
+{
+    if (enc == NULL) return;
+    for (int r = 0; enc->pools != NULL && r < enc->t; r++)
+    {
+        free(enc->pools[r]);
+    }
+    free(enc->cols);
+    free(enc->assigned);
+    free(enc->missing);
+    free(enc->pools);
+    free(enc->pool_sizes);
+    free(enc->pool_capacities);
+    free(enc->complete);
+    free(enc->batch_pools);
+    free(enc->batch_sizes);
+    free(enc);
+}
+
+// hands the queued complete pools to the callback and releases them
+static void flush_complete(cff_pool_encoder_t *enc)
+{
+    int count = enc->num_complete;
+    if (count == 0) return;
+    for (int i = 0; i < count; i++)
+    {
+        enc->batch_pools[i] = enc->pools[enc->complete[i]];
+        enc->batch_sizes[i] = enc->pool_sizes[enc->complete[i]];
+    }
+    enc->flush(count, enc->complete, enc->batch_pools, enc->batch_sizes, enc->user_data);
+    for (int i = 0; i < count; i++)
+    {
+        int r = enc->complete[i];
+        free(enc->pools[r]);
+        enc->pools[r] = NULL;
+        enc->pool_sizes[r] = 0;
+        enc->pool_capacities[r] = -1; // flushed
+    }
+    enc->num_complete = 0;
+}
+
+int cff_pool_encoder_add(cff_pool_encoder_t *enc, long long item, long long column)
+{
+    if (enc == NULL || column < 0 || column >= enc->n) return -1;
+    if ((enc->assigned[column / 8] >> (column % 8)) & 1) return -1; // column already has an item
+    const uint64_t *col = enc->cols + column * enc->w;
+    // make room first, so a rejected column or a failed allocation leaves the pools as they were
+    for (int i = 0; i < enc->w; i++)
+    {
+        for (uint64_t rows = col[i]; rows; rows &= rows - 1)
+        {
+            int r = i * 64 + lowest_bit64(rows);
+            if (enc->pool_capacities[r] < 0) return -1; // its pool was already flushed
+            if (enc->pool_sizes[r] < enc->pool_capacities[r]) continue;
+            long long capacity = enc->pool_capacities[r] > 0 ? enc->pool_capacities[r] * 2 : 8;
+            long long *grown = realloc(enc->pools[r], (size_t) capacity * sizeof(long long));
+            if (grown == NULL) return -1;
+            enc->pools[r] = grown;
+            enc->pool_capacities[r] = capacity;
+        }
+    }
+    enc->assigned[column / 8] |= 1 << (column % 8);
+    for (int i = 0; i < enc->w; i++)
+    {
+        for (uint64_t rows = col[i]; rows; rows &= rows - 1)
+        {
+            int r = i * 64 + lowest_bit64(rows);
+            enc->pools[r][enc->pool_sizes[r]++] = item;
+            if (--enc->missing[r] == 0) // its last column
+            {
+                enc->complete[enc->num_complete++] = r;
+            }
+        }
+    }
+    if (enc->num_complete >= enc->batch_size)
+    {
+        flush_complete(enc);
+    }
+    return 0;
+}
+
+int cff_pool_encoder_flush(cff_pool_encoder_t *enc, bool incomplete)
+{
+    if (enc == NULL) return -1;
+    if (incomplete)
+    { // the pools still waiting for items go out as they are
+        for (int r = 0; r < enc->t; r++)
+        {
+            if (enc->missing[r] > 0) // neither queued nor flushed
+            {
+                enc->missing[r] = 0;
+                enc->complete[enc->num_complete++] = r;
+            }
+        }
+    }
+    int count = enc->num_complete;
+    flush_complete(enc);
+    return count;
+}
+
+const long long* cff_pool_encoder_get_pool(const cff_pool_encoder_t *enc, int test, long long *size)
+{
+    if (enc == NULL || size == NULL || test < 0 || test >= enc->t) return NULL;
+    *size = enc->pool_sizes[test];
+    return enc->pools[test];
+}
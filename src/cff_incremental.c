@@ -0,0 +1,189 @@
+#include "../include/libcfftables/libcfftables.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cff_internals.h"
+
+/*
+    Incremental verification.
+
+    The columns appended so far always form a d-CFF, so when a column x is
+    appended the only subsets that can break the property are the ones that
+    contain x: x together with d (or, while there are fewer, all) of the
+    existing columns. Such a subset S + {x} is cover free when
+      1. x is not contained in the union of S, and
+      2. every s in S keeps a private row outside x and the rest of S.
+    The d-subsets S are enumerated depth first with their unions stacked
+    per depth, so condition 1 can cut off a whole branch as soon as the
+    union of a partial S already covers x.
+*/
+
+struct cff_incremental
+{
+    int d;
+    int t;
+    int w; // 64-bit words per packed column
+    long long n;
+    long long capacity; // in columns
+    uint64_t *cols; // packed columns (as in cff_pack_columns())
+    uint64_t *residuals; // scratch: each column without the rows of the new column
+};
+
+cff_incremental_t* cff_incremental_create(int d, int t)
+{
+    if (d < 1 || t < 1) return NULL;
+    cff_incremental_t *inc = malloc(sizeof(cff_incremental_t));
+    if (inc == NULL) return NULL;
+    inc->d = d;
+    inc->t = t;
+    inc->w = (t + 63) / 64;
+    inc->n = 0;
+    inc->capacity = 64;
+    inc->cols = malloc((size_t) inc->capacity * inc->w * sizeof(uint64_t));
+    inc->residuals = malloc((size_t) inc->capacity * inc->w * sizeof(uint64_t));
+    if (inc->cols == NULL || inc->residuals == NULL)
+    {
+        cff_incremental_free(inc);
+        return NULL;
+    }
+    return inc;
+}
+
+void cff_incremental_free(cff_incremental_t *inc)
+{
+    if (inc == NULL) return;
+    free(inc->cols);
+    free(inc->residuals);
+    free(inc);
+}
+
+// true if no subset made of x, subset[0..depth-1] and k-depth more columns
+// from [start, n) breaks the cover free property. unions[i*w..] is the
+// union of subset[0..i-1]
+static bool extensions_stay_cover_free(const cff_incremental_t *inc, const uint64_t *x,
+                                       int *subset, int depth, int k, long long start,
+                                       uint64_t *unions)
+{
+    int w = inc->w;
+    const uint64_t *prefix = unions + (long long) depth * w;
+    uint64_t *next = unions + (long long) (depth + 1) * w;
+    for (long long c = start; c <= inc->n - (k - depth); c++)
+    {
+        const uint64_t *col = inc->cols + c * w;
+        // condition 1: x must keep a row outside the union
+        uint64_t private_x = 0;
+        for (int i = 0; i < w; i++)
+        {
+            next[i] = prefix[i] | col[i];
+            private_x |= x[i] & ~next[i];
+        }
+        if (!private_x) return false;
+        subset[depth] = (int) c;
+        if (depth + 1 < k)
+        {
+            if (!extensions_stay_cover_free(inc, x, subset, depth + 1, k, c + 1, unions)) return false;
+            continue;
+        }
+        // condition 2: every member keeps a private row outside x and the others
+        for (int j = 0; j < k; j++)
+        {
+            const uint64_t *residual = inc->residuals + (long long) subset[j] * w;
+            uint64_t found = 0;
+            for (int i = 0; i < w && !found; i++)
+            {
+                uint64_t others = 0;
+                for (int m = 0; m < k; m++)
+                {
+                    if (m != j) others |= inc->cols[(long long) subset[m] * w + i];
+                }
+                found |= residual[i] & ~others;
+            }
+            if (!found) return false;
+        }
+    }
+    return true;
+}
+
+bool cff_incremental_append(cff_incremental_t *inc, const int *column)
+{
+    if (inc == NULL || column == NULL || inc->n >= INT32_MAX) return false;
+    int w = inc->w;
+    if (inc->n == inc->capacity)
+    {
+        long long capacity = inc->capacity * 2;
+        uint64_t *cols = realloc(inc->cols, (size_t) capacity * w * sizeof(uint64_t));
+        if (cols == NULL) return false;
+        inc->cols = cols;
+        uint64_t *residuals = realloc(inc->residuals, (size_t) capacity * w * sizeof(uint64_t));
+        if (residuals == NULL) return false;
+        inc->residuals = residuals;
+        inc->capacity = capacity;
+    }
+
+    // pack the new column into the free slot at the end
+    uint64_t *x = inc->cols + inc->n * w;
+    for (int i = 0; i < w; i++) x[i] = 0;
+    for (int r = 0; r < inc->t; r++)
+    {
+        if (column[r]) x[r / 64] |= (uint64_t) 1 << (r % 64);
+    }
+
+    // an empty column has no private row in any subset
+    uint64_t weight = 0;
+    for (int i = 0; i < w; i++) weight |= x[i];
+    if (!weight) return false;
+
+    for (long long c = 0; c < inc->n; c++)
+    {
+        for (int i = 0; i < w; i++)
+        {
+            inc->residuals[c * w + i] = inc->cols[c * w + i] & ~x[i];
+        }
+    }
+
+    int k = inc->n < inc->d ? (int) inc->n : inc->d;
+    bool cover_free;
+    if (k == 0)
+    {
+        cover_free = true;
+    }
+    else
+    {
+        int subset[k];
+        uint64_t *unions = calloc((size_t) (k + 1) * w, sizeof(uint64_t));
+        if (unions == NULL) return false;
+        cover_free = extensions_stay_cover_free(inc, x, subset, 0, k, 0, unions);
+        free(unions);
+    }
+    if (cover_free)
+    {
+        inc->n++;
+    }
+    return cover_free;
+}
+
+long long cff_incremental_get_n(const cff_incremental_t *inc)
+{
+    return inc ? inc->n : 0;
+}
+
+cff_t* cff_incremental_to_cff(const cff_incremental_t *inc)
+{
+    if (inc == NULL || inc->n == 0) return NULL;
+    cff_t *cff = cff_alloc(inc->d, inc->t, inc->n);
+    if (cff == NULL) return NULL;
+    for (long long c = 0; c < inc->n; c++)
+    {
+        const uint64_t *col = inc->cols + c * inc->w;
+        for (int r = 0; r < inc->t; r++)
+        {
+            if ((col[r / 64] >> (r % 64)) & 1)
+            {
+                cff_set_matrix_value(cff, r, (int) c, 1);
+            }
+        }
+    }
+    return cff;
+}
@@ -2,8 +2,29 @@
 #define LIBCFFTABLES_INTERNAL_UTILS_HEADER
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "../include/libcfftables/libcfftables.h"
 
+// how a CFF from the tables was built: one node per construction step
+// (a row of a table), with the CFFs the step was applied to as children.
+// d, t and n are what the step produces, with children in the argument
+// order of the construction function:
+//   ext by one:          {cff}
+//   additive:            {left, right}
+//   doubling:            {cff}
+//   kronecker:           {left, right}
+//   optimized kronecker: {outer, inner, bottom}
+typedef struct cff_recipe
+{
+    short constructionID;
+    short consParams[5];
+    int d;
+    int t;
+    long long n;
+    int num_children;
+    struct cff_recipe *children[3];
+} cff_recipe_t;
+
 // a d-CFF(t, n):
 // there are t subsets of the set n, stored as incidence matrix
 struct cff
@@ -13,6 +34,8 @@ struct cff
     long long n;
     long long stride_bits; // helper for faster memory access
     unsigned char *matrix;
+    cff_recipe_t *recipe; // NULL unless the CFF came from the tables
+    uint64_t matrix_checksum; // checksum of matrix when recipe was attached
 };
 
 typedef struct
@@ -25,7 +48,6 @@ typedef struct
 
 typedef struct
 {
-    bool hasBeenChanged;
     int d;
     int numCFFs;
     int num_loops_when_creating;
@@ -42,6 +64,62 @@ struct cff_table_ctx
     cff_table_t **tables_array;
 };
 
+// number of set bits in a 64-bit word
+static inline int popcount64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    int count = 0;
+    while (x) { x &= x - 1; count++; }
+    return count;
+#endif
+}
+
+// index of the lowest set bit of a nonzero 64-bit word
+static inline int lowest_bit64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int i = 0;
+    while (!(x & 1)) { x >>= 1; i++; }
+    return i;
+#endif
+}
+
+// reads up to 8 bytes as a little-endian word, so bit j of byte b is bit 8b+j
+// (the order of the cells in a row of the matrix). missing bytes are 0
+static inline uint64_t load_le64(const unsigned char *bytes, int num_bytes)
+{
+    uint64_t word = 0;
+    for (int i = 0; i < num_bytes && i < 8; i++)
+    {
+        word |= (uint64_t) bytes[i] << (8 * i);
+    }
+    return word;
+}
+
+// copies the incidence matrix into column-major order: column c is stored in
+// words [c * words_per_column, (c + 1) * words_per_column), with row r in bit r % 64
+// of word r / 64. Returns a malloc'd array (caller frees), or NULL on failure.
+uint64_t* cff_pack_columns(const cff_t *cff, int *words_per_column);
+
+void cff_recipe_free(cff_recipe_t *recipe);
+
+cff_recipe_t* cff_recipe_copy(const cff_recipe_t *recipe);
+
+// FNV-1a hash of the bytes of a CFF's incidence matrix
+uint64_t cff_matrix_checksum(const cff_t *cff);
+
+// gives a CFF built from inputs (in the children order above) the recipe of the construction,
+// if every input still has the recipe it came with
+void cff_attach_product_recipe(cff_t *product, short constructionID, const short params[5],
+                               const cff_t *const *inputs, int num_inputs);
+
+// builds the recipe for row t of the d table (same children as cff_table_get_by_t_rec)
+cff_recipe_t* cff_table_build_recipe(cff_table_ctx_t *ctx, int d, int t);
+
 long long choose(int n, int k);
 
 long factorial(int n);
@@ -50,15 +128,62 @@ void set_to_all_zeros(int n, int *T);
 
 bool k_subset_lex_successor(int n, int k, int *buffer);
 
+// writes the k-subset of Zn with the given lexicographic rank to buffer
+void k_subset_lex_unrank(int n, int k, long long rank, int *buffer);
+
 bool k_tuple_lex_successor(int n, int k, int *buffer);
 
 int ipow(int base, int exp);
 
 void prime_sieve(int n, bool *prime_array);
 
+// factor[i] = the smallest prime factor of i, for i = 2 ... n (factor has n + 1 entries)
+void smallest_factor_sieve(int n, int *factor);
+
+// qsort()/bsearch() comparison of long longs in increasing order
+int cff_compare_long_long(const void *a, const void *b);
+
+// a table of numCFFs rows of identity matrices, exits if out of memory
+cff_table_t* initializeTable(int numCFFs, int cff_d, long long n_max);
+
+// the tables linked into the library, built at build time by generate_embedded_tables.c with
+// cff_table_create(CFF_EMBEDDED_D_MAX, CFF_EMBEDDED_T_MAX, CFF_EMBEDDED_N_MAX). Only the rows that
+// differ from cff_embedded_default_row() are stored. Every table reaches CFF_EMBEDDED_N_MAX
+// before CFF_EMBEDDED_T_MAX, so the tables for any smaller bounds can be cut from them
+#define CFF_EMBEDDED_D_MAX 25
+#define CFF_EMBEDDED_T_MAX 30000
+#define CFF_EMBEDDED_N_MAX 100000000000000LL
+
+typedef struct
+{
+    long long n;
+    int t;
+    short constructionID;
+    short consParams[5];
+} cff_embedded_row_t;
+
+typedef struct
+{
+    int numCFFs;
+    int first_row; // its stored rows in cff_embedded_rows
+    int num_rows;
+} cff_embedded_table_t;
+
+// tables for d = 2 ... cff_embedded_num_tables + 1, none if the library was built without them
+extern const int cff_embedded_num_tables;
+extern const cff_embedded_table_t cff_embedded_tables[];
+extern const cff_embedded_row_t cff_embedded_rows[];
+
+// row t of a d table when it is not stored: extension by one of the previous row if that has
+// more columns than the identity matrix, otherwise the identity matrix
+void cff_embedded_default_row(int cff_d, int t, const cff_table_row_t *previous, cff_table_row_t *row);
+
 // helper to search table for some row with a cff with at least n columns
 int binary_search_table(cff_table_t *table, long long n);
 
+// the same, searching only the first rows of the table
+int binary_search_table_rows(cff_table_t *table, long long n, int rows);
+
 // called in loops to check constructions to update table with newly found CFFs
 void update_table(
     cff_table_t *table,
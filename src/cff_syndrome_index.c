@@ -0,0 +1,225 @@
+#include "../include/libcfftables/libcfftables.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+
+#include "cff_internals.h"
+
+/*
+    Syndrome index.
+
+    For a d-CFF every set of at most d positive items gives a different
+    outcome vector (its syndrome), so all of them can be listed up front
+    and decoding becomes one hash table lookup. The table is open addressed
+    with linear probing and kept at most half full: slot i holds the packed
+    outcome words of a set (the key) and the items of the set. The key is
+    hashed word by word with a 64-bit mixer, the syndromes are built from
+    the packed columns by OR-ing the columns of each subset.
+*/
+
+#define EMPTY_SLOT 0xFF
+
+struct cff_syndrome_index
+{
+    int d;
+    int t;
+    int w; // words per key
+    long long capacity; // slots, a power of 2
+    uint64_t *keys; // w words per slot
+    long long *items; // d items per slot
+    unsigned char *sizes; // number of items per slot, or EMPTY_SLOT
+};
+
+// the number of subsets of at most d of n items, or -1 if it overflows
+static long long count_subsets(long long n, int d)
+{
+    long long total = 0;
+    long long binomial = 1; // n choose i
+    for (int i = 0; i <= d && i <= n; i++)
+    {
+        if (total > LLONG_MAX - binomial) return -1;
+        total += binomial;
+        // n choose i+1 = (n choose i) (n - i) / (i + 1), exact when divided after multiplying
+        if (binomial > LLONG_MAX / (n - i > 0 ? n - i : 1)) return -1;
+        binomial = binomial * (n - i) / (i + 1);
+    }
+    return total;
+}
+
+// the number of slots for a number of entries: a power of 2, at least twice as many
+static long long slots_for(long long entries)
+{
+    long long capacity = 1;
+    while (capacity < 2 * entries)
+    {
+        if (capacity > LLONG_MAX / 2) return -1;
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+long long cff_syndrome_index_estimate_size(const cff_t *cff, int d)
+{
+    if (cff == NULL || d < 1) return -1;
+    long long entries = count_subsets(cff->n, d);
+    if (entries < 0 || entries > LLONG_MAX / 2) return -1;
+    long long capacity = slots_for(entries);
+    if (capacity < 0) return -1;
+    long long w = (cff->t + 63) / 64 > 0 ? (cff->t + 63) / 64 : 1;
+    long long slot_bytes = w * (long long) sizeof(uint64_t) + d * (long long) sizeof(long long) + 1;
+    if (capacity > (LLONG_MAX - (long long) sizeof(cff_syndrome_index_t)) / slot_bytes) return -1;
+    return capacity * slot_bytes + (long long) sizeof(cff_syndrome_index_t);
+}
+
+static uint64_t hash_key(const uint64_t *key, int w)
+{
+    uint64_t hash = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < w; i++)
+    {
+        uint64_t x = hash ^ key[i];
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        hash = x;
+    }
+    return hash;
+}
+
+// the slot holding key, or the empty slot where it would go
+static long long find_slot(const cff_syndrome_index_t *idx, const uint64_t *key)
+{
+    long long mask = idx->capacity - 1;
+    long long slot = (long long) (hash_key(key, idx->w) & (uint64_t) mask);
+    while (idx->sizes[slot] != EMPTY_SLOT
+           && memcmp(idx->keys + slot * idx->w, key, idx->w * sizeof(uint64_t)) != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void cff_syndrome_index_free(cff_syndrome_index_t *idx)
+{
+    if (idx == NULL) return;
+    free(idx->keys);
+    free(idx->items);
+    free(idx->sizes);
+    free(idx);
+}
+
+// adds every subset of size k, false if two sets share a syndrome or k is too large for n
+static bool insert_subsets(cff_syndrome_index_t *idx, const uint64_t *cols, long long n, int k)
+{
+    if (k > n) return true;
+    int w = idx->w;
+    long long subset[k > 0 ? k : 1];
+    uint64_t key[w];
+    for (int i = 0; i < k; i++)
+    {
+        subset[i] = i;
+    }
+    for (;;)
+    {
+        memset(key, 0, w * sizeof(uint64_t));
+        for (int i = 0; i < k; i++)
+        {
+            for (int j = 0; j < w; j++)
+            {
+                key[j] |= cols[subset[i] * w + j];
+            }
+        }
+        long long slot = find_slot(idx, key);
+        if (idx->sizes[slot] != EMPTY_SLOT) return false; // not d-separable
+        memcpy(idx->keys + slot * w, key, w * sizeof(uint64_t));
+        for (int i = 0; i < k; i++)
+        {
+            idx->items[slot * idx->d + i] = subset[i];
+        }
+        idx->sizes[slot] = (unsigned char) k;
+
+        // next k-subset in lexicographic order
+        int i = k - 1;
+        while (i >= 0 && subset[i] == n - k + i) i--;
+        if (i < 0) return true;
+        subset[i]++;
+        for (int j = i + 1; j < k; j++)
+        {
+            subset[j] = subset[j - 1] + 1;
+        }
+    }
+}
+
+cff_syndrome_index_t* cff_syndrome_index_create(const cff_t *cff, int d)
+{
+    if (cff == NULL || d < 1 || d > cff->d || d >= EMPTY_SLOT) return NULL;
+    long long entries = count_subsets(cff->n, d);
+    if (entries < 0 || entries > LLONG_MAX / 2) return NULL;
+    cff_syndrome_index_t *idx = malloc(sizeof(cff_syndrome_index_t));
+    if (idx == NULL) return NULL;
+    idx->d = d;
+    idx->t = cff->t;
+    idx->w = (cff->t + 63) / 64 > 0 ? (cff->t + 63) / 64 : 1;
+    idx->capacity = slots_for(entries);
+    idx->keys = NULL;
+    idx->items = NULL;
+    idx->sizes = NULL;
+    if (idx->capacity < 0)
+    {
+        cff_syndrome_index_free(idx);
+        return NULL;
+    }
+    idx->keys = malloc((size_t) idx->capacity * idx->w * sizeof(uint64_t));
+    idx->items = malloc((size_t) idx->capacity * d * sizeof(long long));
+    idx->sizes = malloc((size_t) idx->capacity);
+    int w;
+    uint64_t *cols = cff_pack_columns(cff, &w);
+    if (idx->keys == NULL || idx->items == NULL || idx->sizes == NULL || cols == NULL)
+    {
+        free(cols);
+        cff_syndrome_index_free(idx);
+        return NULL;
+    }
+    memset(idx->sizes, EMPTY_SLOT, (size_t) idx->capacity);
+    bool ok = true;
+    for (int k = 0; k <= d && ok; k++)
+    {
+        ok = insert_subsets(idx, cols, cff->n, k);
+    }
+    free(cols);
+    if (!ok)
+    {
+        cff_syndrome_index_free(idx);
+        return NULL;
+    }
+    return idx;
+}
+
+long long cff_syndrome_index_lookup(const cff_syndrome_index_t *idx, const unsigned char *outcomes,
+                                    long long *positives, long long max_positives)
+{
+    if (idx == NULL || outcomes == NULL) return -1;
+    uint64_t key[idx->w];
+    long long outcome_bytes = (idx->t + 7) / 8;
+    for (int i = 0; i < idx->w; i++)
+    {
+        long long bytes = outcome_bytes - i * 8 < 8 ? outcome_bytes - i * 8 : 8;
+        key[i] = bytes > 0 ? load_le64(outcomes + i * 8, (int) bytes) : 0;
+        if (i == idx->w - 1 && idx->t % 64)
+        { // bits past t
+            key[i] &= ((uint64_t) 1 << (idx->t % 64)) - 1;
+        }
+    }
+    long long slot = find_slot(idx, key);
+    if (idx->sizes[slot] == EMPTY_SLOT) return -1; // not the outcome of at most d positives
+    int size = idx->sizes[slot];
+    for (int i = 0; i < size && i < max_positives && positives != NULL; i++)
+    {
+        positives[i] = idx->items[slot * idx->d + i];
+    }
+    return size;
+}
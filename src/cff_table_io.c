@@ -0,0 +1,242 @@
+#include "../include/libcfftables/libcfftables.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cff_internals.h"
+#include "constructions/construction_internals.h"
+
+/*
+    Table files.
+
+    A file holds the rows of every table of a context, so a process can load
+    tables instead of creating them. All fields are little-endian:
+
+        header (64 bytes):
+            "CFFTABLE", format version (u32), library version (16 chars, 0 padded),
+            d_max (i32), t_max (i32), n_max (i64),
+            payload size (u64), FNV-1a checksum of the payload (u64), 4 zero bytes
+        payload, per table d = 1 ... d_max:
+            d (i32), numCFFs (i32), n_max (i64),
+            numCFFs rows of n (i64), constructionID (i16), consParams (5 x i16)
+
+    A file is only loaded for the bounds and the library version it was saved
+    with, since the rows depend on both. The loader reads the whole file and
+    checks it before decoding the rows into the tables. The checksum only
+    catches accidental damage, so every row that names other rows (the
+    recursive constructions) is also checked to name rows that exist, as
+    cff_table_get_by_t() follows them without checks.
+*/
+
+#ifndef LIBCFFTABLES_VERSION
+#define LIBCFFTABLES_VERSION "unknown"
+#endif
+
+#define TABLE_FILE_FORMAT 1
+#define TABLE_FILE_HEADER_BYTES 64
+#define TABLE_FILE_VERSION_BYTES 16
+#define TABLE_FILE_TABLE_BYTES 16
+#define TABLE_FILE_ROW_BYTES 20
+
+static void store_le(unsigned char *bytes, uint64_t value, int num_bytes)
+{
+    for (int i = 0; i < num_bytes; i++)
+    {
+        bytes[i] = (unsigned char) (value >> (8 * i));
+    }
+}
+
+static uint64_t payload_checksum(const unsigned char *bytes, size_t num_bytes)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < num_bytes; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// the header of a file for these bounds, without the payload size and checksum
+static void write_header(unsigned char *header, int d_max, int t_max, long long n_max)
+{
+    memset(header, 0, TABLE_FILE_HEADER_BYTES);
+    memcpy(header, "CFFTABLE", 8);
+    store_le(header + 8, TABLE_FILE_FORMAT, 4);
+    strncpy((char *) header + 12, LIBCFFTABLES_VERSION, TABLE_FILE_VERSION_BYTES);
+    store_le(header + 28, (uint32_t) d_max, 4);
+    store_le(header + 32, (uint32_t) t_max, 4);
+    store_le(header + 36, (uint64_t) n_max, 8);
+}
+
+int cff_table_save(const cff_table_ctx_t *ctx, const char *path)
+{
+    if (ctx == NULL || path == NULL) return -1;
+    size_t payload_bytes = 0;
+    for (int i = 0; i < ctx->d_max; i++)
+    {
+        payload_bytes += TABLE_FILE_TABLE_BYTES + (size_t) ctx->tables_array[i]->numCFFs * TABLE_FILE_ROW_BYTES;
+    }
+    unsigned char *bytes = malloc(TABLE_FILE_HEADER_BYTES + payload_bytes);
+    if (bytes == NULL) return -1;
+    unsigned char *pos = bytes + TABLE_FILE_HEADER_BYTES;
+    for (int i = 0; i < ctx->d_max; i++)
+    {
+        const cff_table_t *table = ctx->tables_array[i];
+        store_le(pos, (uint32_t) table->d, 4);
+        store_le(pos + 4, (uint32_t) table->numCFFs, 4);
+        store_le(pos + 8, (uint64_t) table->n_max, 8);
+        pos += TABLE_FILE_TABLE_BYTES;
+        for (int t = 0; t < table->numCFFs; t++)
+        {
+            const cff_table_row_t *row = &table->array[t];
+            store_le(pos, (uint64_t) row->n, 8);
+            store_le(pos + 8, (uint16_t) row->constructionID, 2);
+            for (int j = 0; j < 5; j++)
+            {
+                store_le(pos + 10 + 2 * j, (uint16_t) row->consParams[j], 2);
+            }
+            pos += TABLE_FILE_ROW_BYTES;
+        }
+    }
+    write_header(bytes, ctx->d_max, ctx->t_max, ctx->n_max);
+    store_le(bytes + 44, payload_bytes, 8);
+    store_le(bytes + 52, payload_checksum(bytes + TABLE_FILE_HEADER_BYTES, payload_bytes), 8);
+
+    FILE *fptr = fopen(path, "wb");
+    if (fptr == NULL)
+    {
+        free(bytes);
+        return -1;
+    }
+    size_t written = fwrite(bytes, 1, TABLE_FILE_HEADER_BYTES + payload_bytes, fptr);
+    int closed = fclose(fptr);
+    free(bytes);
+    return written == TABLE_FILE_HEADER_BYTES + payload_bytes && closed == 0 ? 0 : -1;
+}
+
+// whether the rows a row is built from are in the tables decoded so far (the tables below d and
+// the rows of table d below t)
+static bool row_is_valid(const cff_table_ctx_t *ctx, int d, int t, const cff_table_row_t *row)
+{
+    const short *params = row->consParams;
+    switch (row->constructionID)
+    {
+    case CFF_CONSTRUCTION_ID_IDENTITY_MATRIX:
+    case CFF_CONSTRUCTION_ID_SPERNER:
+    case CFF_CONSTRUCTION_ID_STS:
+    case CFF_CONSTRUCTION_ID_PORAT_ROTHSCHILD:
+    case CFF_CONSTRUCTION_ID_REED_SOLOMON:
+    case CFF_CONSTRUCTION_ID_SHORT_REED_SOLOMON:
+    case CFF_CONSTRUCTION_ID_FIXED_CFF:
+        return true;
+    case CFF_CONSTRUCTION_ID_EXT_BY_ONE:
+        return params[0] >= 1 && params[0] < t;
+    case CFF_CONSTRUCTION_ID_DOUBLING: // built from a row of the 2-CFF table
+        return d == 2 && params[0] >= 1 && params[0] < t;
+    case CFF_CONSTRUCTION_ID_ADDITIVE:
+    case CFF_CONSTRUCTION_ID_KRONECKER:
+        return params[0] >= 1 && params[0] < t && params[1] >= 1 && params[1] < t;
+    case CFF_CONSTRUCTION_ID_OPTIMIZED_KRONECKER: // the outer CFF is from the (d-1)-CFF table
+        return d >= 2 && params[0] >= 1 && params[0] < t && params[1] >= 1 && params[1] < t
+               && params[2] >= 1 && params[2] < t && params[2] < ctx->tables_array[d-2]->numCFFs;
+    default:
+        return false;
+    }
+}
+
+// the tables in a file, or NULL if the file is not for these bounds or is damaged
+static cff_table_ctx_t* decode_tables(const unsigned char *bytes, size_t num_bytes,
+                                      int d_maximum, int t_maximum, long long n_maximum)
+{
+    unsigned char expected[TABLE_FILE_HEADER_BYTES];
+    write_header(expected, d_maximum, t_maximum, n_maximum);
+    if (num_bytes < TABLE_FILE_HEADER_BYTES || memcmp(bytes, expected, 44) != 0) return NULL;
+    size_t payload_bytes = num_bytes - TABLE_FILE_HEADER_BYTES;
+    const unsigned char *payload = bytes + TABLE_FILE_HEADER_BYTES;
+    if (load_le64(bytes + 44, 8) != payload_bytes
+        || load_le64(bytes + 52, 8) != payload_checksum(payload, payload_bytes))
+    {
+        return NULL;
+    }
+
+    cff_table_ctx_t *ctx = malloc(sizeof(cff_table_ctx_t));
+    if (ctx == NULL) return NULL;
+    ctx->d_max = 0; // tables decoded so far, so a failure frees only those
+    ctx->t_max = t_maximum;
+    ctx->n_max = n_maximum;
+    ctx->tables_array = malloc(sizeof(cff_table_t*) * d_maximum);
+    if (ctx->tables_array == NULL)
+    {
+        free(ctx);
+        return NULL;
+    }
+    const unsigned char *pos = payload;
+    const unsigned char *end = payload + payload_bytes;
+    for (int i = 0; i < d_maximum; i++)
+    {
+        if (end - pos < TABLE_FILE_TABLE_BYTES) break;
+        int d = (int32_t) load_le64(pos, 4);
+        int numCFFs = (int32_t) load_le64(pos + 4, 4);
+        long long n_max = (long long) load_le64(pos + 8, 8);
+        pos += TABLE_FILE_TABLE_BYTES;
+        if (d != i + 1 || numCFFs < 1 || (end - pos) / TABLE_FILE_ROW_BYTES < numCFFs) break;
+        cff_table_t *table = initializeTable(numCFFs, d, n_max);
+        table->num_loops_when_creating = 1;
+        ctx->tables_array[ctx->d_max++] = table;
+        bool ok = true;
+        for (int t = 0; t < numCFFs; t++)
+        {
+            cff_table_row_t *row = &table->array[t];
+            row->n = (long long) load_le64(pos, 8);
+            row->constructionID = (int16_t) load_le64(pos + 8, 2);
+            for (int j = 0; j < 5; j++)
+            {
+                row->consParams[j] = (int16_t) load_le64(pos + 10 + 2 * j, 2);
+            }
+            pos += TABLE_FILE_ROW_BYTES;
+            ok &= row_is_valid(ctx, d, t, row);
+        }
+        if (!ok) break;
+    }
+    if (ctx->d_max != d_maximum || pos != end)
+    {
+        cff_table_free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+cff_table_ctx_t* cff_table_load(const char *path, int d_maximum, int t_maximum, long long n_maximum)
+{
+    if (path == NULL || d_maximum < 1) return NULL;
+    if (t_maximum > n_maximum)
+    { // as in cff_table_create()
+        t_maximum = n_maximum;
+    }
+    FILE *fptr = fopen(path, "rb");
+    if (fptr == NULL) return NULL;
+    long num_bytes = -1;
+    if (fseek(fptr, 0, SEEK_END) == 0)
+    {
+        num_bytes = ftell(fptr);
+    }
+    if (num_bytes < TABLE_FILE_HEADER_BYTES || fseek(fptr, 0, SEEK_SET) != 0)
+    {
+        fclose(fptr);
+        return NULL;
+    }
+    unsigned char *bytes = malloc((size_t) num_bytes);
+    bool read = bytes != NULL && fread(bytes, 1, (size_t) num_bytes, fptr) == (size_t) num_bytes;
+    fclose(fptr);
+    cff_table_ctx_t *ctx = NULL;
+    if (read)
+    {
+        ctx = decode_tables(bytes, (size_t) num_bytes, d_maximum, t_maximum, n_maximum);
+    }
+    free(bytes);
+    return ctx;
+}
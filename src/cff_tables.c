@@ -1,8 +1,14 @@
+#define _POSIX_C_SOURCE 200809L // sysconf()
+#define _DARWIN_C_SOURCE // _SC_NPROCESSORS_ONLN, which strict POSIX on macOS hides
+
 #include "../include/libcfftables/libcfftables.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include "cff_internals.h"
 
@@ -124,6 +130,120 @@ cff_t* cff_table_get_by_t_rec(cff_table_ctx_t *ctx, int d, int t, intermediate_c
     return cff;
 }
 
+// a * b and q^k for non-negative values, saturating at LLONG_MAX instead of overflowing
+static long long saturating_mul(long long a, long long b)
+{
+    if (b != 0 && a > LLONG_MAX / b) return LLONG_MAX;
+    return a * b;
+}
+
+static long long saturating_pow(long long q, int k)
+{
+    long long result = 1;
+    for (int i = 0; i < k; i++)
+    {
+        result = saturating_mul(result, q);
+    }
+    return result;
+}
+
+// the n produced by the recipe node's construction, from its children
+static long long recipe_node_n(const cff_table_row_t *row, const cff_recipe_t *node)
+{
+    const short *p = row->consParams;
+    cff_recipe_t *const *c = node->children;
+    switch (row->constructionID)
+    {
+    case CFF_CONSTRUCTION_ID_IDENTITY_MATRIX:
+        return p[0];
+    case CFF_CONSTRUCTION_ID_SPERNER:
+        return row->n;
+    case CFF_CONSTRUCTION_ID_STS:
+        return ((long long) p[0] * (p[0] - 1)) / 6;
+    case CFF_CONSTRUCTION_ID_PORAT_ROTHSCHILD:
+    case CFF_CONSTRUCTION_ID_REED_SOLOMON:
+        return saturating_pow(saturating_pow(p[0], p[1]), p[2]);
+    case CFF_CONSTRUCTION_ID_SHORT_REED_SOLOMON:
+        return saturating_pow(saturating_pow(p[0], p[1]), p[2] - p[4]);
+    case CFF_CONSTRUCTION_ID_FIXED_CFF:
+        return cff_fixed_get_n(node->d, node->t);
+    case CFF_CONSTRUCTION_ID_EXT_BY_ONE:
+        return c[0]->n + 1;
+    case CFF_CONSTRUCTION_ID_ADDITIVE:
+        return c[0]->n + c[1]->n;
+    case CFF_CONSTRUCTION_ID_DOUBLING:
+        return 2 * c[0]->n;
+    case CFF_CONSTRUCTION_ID_KRONECKER:
+        return saturating_mul(c[0]->n, c[1]->n);
+    case CFF_CONSTRUCTION_ID_OPTIMIZED_KRONECKER:
+        return saturating_mul(c[1]->n, c[2]->n);
+    default:
+        return -1;
+    }
+}
+
+cff_recipe_t* cff_table_build_recipe(cff_table_ctx_t *ctx, int d, int t)
+{
+    const cff_table_row_t *row = &ctx->tables_array[d-1]->array[t];
+    cff_recipe_t *node = malloc(sizeof(cff_recipe_t));
+    if (node == NULL) return NULL;
+    node->constructionID = row->constructionID;
+    for (int i = 0; i < 5; i++)
+    {
+        node->consParams[i] = row->consParams[i];
+    }
+    node->d = d;
+    node->t = t;
+    node->num_children = 0;
+
+    // the (d, t) of each child, in the same order cff_table_get_by_t_rec passes them
+    int child_d[3] = {d, d, d};
+    int child_t[3];
+    switch (row->constructionID)
+    {
+    case CFF_CONSTRUCTION_ID_EXT_BY_ONE:
+        node->num_children = 1;
+        child_t[0] = row->consParams[0];
+        break;
+    case CFF_CONSTRUCTION_ID_ADDITIVE:
+        node->num_children = 2;
+        child_t[0] = row->consParams[1];
+        child_t[1] = row->consParams[0];
+        break;
+    case CFF_CONSTRUCTION_ID_DOUBLING:
+        node->num_children = 1;
+        child_d[0] = 2;
+        child_t[0] = row->consParams[0];
+        break;
+    case CFF_CONSTRUCTION_ID_KRONECKER:
+        node->num_children = 2;
+        child_t[0] = row->consParams[0];
+        child_t[1] = row->consParams[1];
+        break;
+    case CFF_CONSTRUCTION_ID_OPTIMIZED_KRONECKER:
+        node->num_children = 3;
+        child_d[0] = d - 1;
+        child_t[0] = row->consParams[2];
+        child_t[1] = row->consParams[0];
+        child_t[2] = row->consParams[1];
+        break;
+    default:
+        break;
+    }
+    for (int i = 0; i < node->num_children; i++)
+    {
+        node->children[i] = cff_table_build_recipe(ctx, child_d[i], child_t[i]);
+        if (node->children[i] == NULL)
+        {
+            node->num_children = i;
+            cff_recipe_free(node);
+            return NULL;
+        }
+    }
+    node->n = recipe_node_n(row, node);
+    return node;
+}
+
 cff_t* cff_table_get_by_t(cff_table_ctx_t *ctx, int d, int t)
 {
     if (d < 1 || t < 1) return NULL;
@@ -153,6 +273,13 @@ cff_t* cff_table_get_by_t(cff_table_ctx_t *ctx, int d, int t)
         free(curr);
         curr = next;
     }
+
+    // remember how the CFF was built, so it can be certified with cff_verify_by_construction()
+    if (cff != NULL)
+    {
+        cff->recipe = cff_table_build_recipe(ctx, d, t);
+        cff->matrix_checksum = cff_matrix_checksum(cff);
+    }
     return cff;
 }
 
@@ -197,13 +324,16 @@ void update_table(
         table->array[t].consParams[3] = (short) consParam3;
         table->array[t].consParams[4] = (short) consParam4;
         table->array[t].constructionID = (short) constructionID;
-        table->hasBeenChanged = true;
     }
 }
 
 int binary_search_table(cff_table_t *table, long long n) {
+    return binary_search_table_rows(table, n, table->numCFFs);
+}
+
+int binary_search_table_rows(cff_table_t *table, long long n, int rows) {
     int low = 0;
-    int high = table->numCFFs - 1;
+    int high = rows - 1;
 
     if (table->array[high].n < n) {
         return -1; // n is not present in the range
@@ -228,6 +358,19 @@ int binary_search_table(cff_table_t *table, long long n) {
     return low;
 }
 
+// the row of the t by t identity matrix, where every table starts
+static void set_identity_row(cff_table_row_t *row, int t)
+{
+    row->n = t;
+    row->consParams[0] = t;
+    row->consParams[1] = 0;
+    row->consParams[2] = 0;
+    row->consParams[3] = 0;
+    row->consParams[4] = 0;
+    row->constructionID = (short) CFF_CONSTRUCTION_ID_IDENTITY_MATRIX;
+    row->cff = NULL;
+}
+
 // helper used in makeTables()
 cff_table_t* initializeTable(int numCFFs, int cff_d, long long n_max)
 {
@@ -237,7 +380,6 @@ cff_table_t* initializeTable(int numCFFs, int cff_d, long long n_max)
         printf("malloc fail'd table in initializeTable\n");
         exit(1);
     }
-    table->hasBeenChanged = false;
     table->numCFFs = numCFFs;
     table->d = cff_d;
     table->n_max = n_max;
@@ -251,14 +393,7 @@ cff_table_t* initializeTable(int numCFFs, int cff_d, long long n_max)
     // fill table with ID matices
     for (int t = 0; t < numCFFs + 1; t++)
     {
-        table->array[t].n = t;
-        table->array[t].consParams[0] = t;
-        table->array[t].consParams[1] = 0;
-        table->array[t].consParams[2] = 0;
-        table->array[t].consParams[3] = 0;
-        table->array[t].consParams[4] = 0;
-        table->array[t].constructionID = (short) CFF_CONSTRUCTION_ID_IDENTITY_MATRIX;
-        table->array[t].cff = NULL;
+        set_identity_row(&table->array[t], t);
     }
     return table;
 }
@@ -277,6 +412,246 @@ cff_table_t* makeSpernerTable()
     return table;
 }
 
+/*
+    Building the tables for d = 2 ... d_max.
+
+    The direct constructions of one table do not depend on the other tables,
+    and the recursive ones read the (d-1) table only to find, for the n of a
+    row below t, the smallest t with a (d-1)-CFF on n columns (for optimized
+    Kronecker). The rows of a table are strictly increasing in n, so once the
+    rows of the (d-1) table below some row are final and that row has at least
+    that n, searching the final rows gives the same answer as searching the
+    whole finished table. So each table is built by its own thread, which
+    before pulling row t waits only until the (d-1) table has a final row with
+    at least the n of row t-1, and the tables are built as a wavefront instead
+    of one after another. Threads take the next table in order of d when they
+    finish one, so the table a thread waits on is always being built.
+
+    A table can start pulling at a later row when the rows below it are
+    already final (see cff_table_extend()), and one with no rows to pull is
+    finished from the start.
+*/
+
+typedef struct
+{
+    cff_table_ctx_t *ctx;
+    int t_max;
+    bool *prime_array;
+    int *smallest_factor;
+    pthread_mutex_t lock; // guards the fields below
+    pthread_cond_t progress; // signalled when a table has more final rows
+    int next_d; // the next table to build
+    int *first_row; // per d, the first row to pull, or -1 if the table is final
+    int *rows_done; // per d, the rows below this are final
+    bool *finished; // per d, every row is final
+} table_build_t;
+
+// the number of final rows of the (d-1) table that can be searched for n
+static int wait_for_rows(table_build_t *build, int cff_d, long long n)
+{
+    cff_table_t *lower = build->ctx->tables_array[cff_d-2];
+    pthread_mutex_lock(&build->lock);
+    while (!build->finished[cff_d-1]
+           && (build->rows_done[cff_d-1] == 0 || lower->array[build->rows_done[cff_d-1] - 1].n < n))
+    {
+        pthread_cond_wait(&build->progress, &build->lock);
+    }
+    int rows = build->rows_done[cff_d-1];
+    pthread_mutex_unlock(&build->lock);
+    return rows;
+}
+
+static void publish_rows(table_build_t *build, int cff_d, int rows, bool finished)
+{
+    pthread_mutex_lock(&build->lock);
+    build->rows_done[cff_d] = rows;
+    build->finished[cff_d] = finished;
+    pthread_cond_broadcast(&build->progress);
+    pthread_mutex_unlock(&build->lock);
+}
+
+static void build_table(table_build_t *build, int cff_d)
+{
+    cff_table_ctx_t *ctx = build->ctx;
+    cff_table_t *table = ctx->tables_array[cff_d-1];
+    if (cff_d == 2)
+    { // 2-CFFs have more constructions
+        cff_table_add_fixed_cffs(ctx);
+        cff_table_add_sts_cffs(ctx, build->t_max);
+    }
+    cff_table_add_reed_solomon_cffs(ctx, cff_d, build->t_max, build->prime_array);
+    cff_table_add_porat_rothschild_cffs(ctx, cff_d, build->t_max, build->prime_array);
+
+    // every recursive construction makes row t from rows below t, so one pass of increasing t
+    // where each row takes the best of its candidates leaves every row final
+    int first_row = build->first_row[cff_d];
+    publish_rows(build, cff_d, first_row < table->numCFFs ? first_row : table->numCFFs, false);
+    pair_pull_index_t *pairs = cff_table_pair_pull_create(ctx, cff_d, build->smallest_factor);
+    for (int t = first_row; t < table->numCFFs; t++)
+    {
+        int lower_rows = wait_for_rows(build, cff_d, table->array[t-1].n);
+        if (cff_d == 2)
+        {
+            cff_table_pull_doubling_cff(ctx, t);
+        }
+        cff_table_pull_ext_by_one_cff(ctx, cff_d, t);
+        cff_table_pull_pair_constructed_cffs(pairs, t, lower_rows);
+        publish_rows(build, cff_d, t + 1, false);
+    }
+    cff_table_pair_pull_free(pairs);
+    table->num_loops_when_creating = 1;
+    publish_rows(build, cff_d, table->numCFFs, true);
+}
+
+static void* build_tables(void *arg)
+{
+    table_build_t *build = arg;
+    for (;;)
+    {
+        pthread_mutex_lock(&build->lock);
+        int cff_d = build->next_d++;
+        bool finished = cff_d <= build->ctx->d_max && build->finished[cff_d];
+        pthread_mutex_unlock(&build->lock);
+        if (cff_d > build->ctx->d_max) return NULL;
+        if (!finished) build_table(build, cff_d);
+    }
+}
+
+// builds the rows of the tables from first_row[d] on (-1 for a final table), on as many threads as
+// there are cores
+static void build_rows(cff_table_ctx_t *ctx, int *first_row)
+{
+    // create an array of booleans to determine if numbers are prime
+    bool *prime_array = malloc(sizeof(bool)*ctx->t_max + 1);
+    prime_sieve(ctx->t_max, prime_array);
+
+    table_build_t build;
+    build.ctx = ctx;
+    build.t_max = ctx->t_max;
+    build.prime_array = prime_array;
+    build.smallest_factor = malloc(sizeof(int) * (ctx->t_max + 1));
+    smallest_factor_sieve(ctx->t_max, build.smallest_factor);
+    build.next_d = 2;
+    build.first_row = first_row;
+    build.rows_done = calloc(ctx->d_max + 1, sizeof(int));
+    build.finished = calloc(ctx->d_max + 1, sizeof(bool));
+    pthread_mutex_init(&build.lock, NULL);
+    pthread_cond_init(&build.progress, NULL);
+    build.finished[1] = true;
+    build.rows_done[1] = ctx->tables_array[0]->numCFFs;
+    int num_tables = 0;
+    for (int cff_d = 2; cff_d < ctx->d_max+1; cff_d++)
+    {
+        build.finished[cff_d] = first_row[cff_d] < 0;
+        build.rows_done[cff_d] = build.finished[cff_d] ? ctx->tables_array[cff_d-1]->numCFFs : 0;
+        num_tables += !build.finished[cff_d];
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int num_threads = num_tables < cpus ? num_tables : (int) cpus;
+    if (num_threads < 1) num_threads = 1;
+    pthread_t threads[num_threads];
+    bool started[num_threads];
+    for (int i = 1; i < num_threads; i++)
+    {
+        // a thread that cannot be started leaves its tables to the others
+        started[i] = pthread_create(&threads[i], NULL, build_tables, &build) == 0;
+    }
+    build_tables(&build);
+    for (int i = 1; i < num_threads; i++)
+    {
+        if (started[i]) pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&build.lock);
+    pthread_cond_destroy(&build.progress);
+    free(build.rows_done);
+    free(build.finished);
+    free(build.smallest_factor);
+    free(prime_array);
+}
+
+/*
+    Embedded tables.
+
+    A row whose n is below n_max gets the same candidates for any bounds, so
+    the rows of the tables created for smaller bounds are the embedded rows
+    up to the first one with at least n_max columns. There the table stops,
+    as in update_table(), with n = n_max and the construction of the embedded
+    row (or the identity matrix if t = n_max, whose row update_table() never
+    changes), which has at least n_max columns.
+*/
+
+void cff_embedded_default_row(int cff_d, int t, const cff_table_row_t *previous, cff_table_row_t *row)
+{
+    bool extend = t - 1 > cff_d && previous->n + 1 > t; // as cff_table_pull_ext_by_one_cff()
+    row->n = extend ? previous->n + 1 : t;
+    row->consParams[0] = (short) (extend ? t - 1 : t);
+    for (int i = 1; i < 5; i++)
+    {
+        row->consParams[i] = 0;
+    }
+    row->constructionID = (short) (extend ? CFF_CONSTRUCTION_ID_EXT_BY_ONE : CFF_CONSTRUCTION_ID_IDENTITY_MATRIX);
+}
+
+// fills the rows of table from the embedded table, false if they run out before t_maximum
+static bool cut_embedded_table(cff_table_t *table, int t_maximum)
+{
+    const cff_embedded_table_t *source = &cff_embedded_tables[table->d - 2];
+    const cff_embedded_row_t *stored = cff_embedded_rows + source->first_row;
+    const cff_embedded_row_t *stored_end = stored + source->num_rows;
+    for (int t = 1; t <= t_maximum; t++)
+    {
+        if (t >= source->numCFFs) return false;
+        cff_table_row_t *row = &table->array[t];
+        if (stored < stored_end && stored->t == t)
+        {
+            row->n = stored->n;
+            memcpy(row->consParams, stored->consParams, sizeof(row->consParams));
+            row->constructionID = stored->constructionID;
+            stored++;
+        } else
+        {
+            cff_embedded_default_row(table->d, t, &table->array[t-1], row);
+        }
+        if (row->n >= table->n_max)
+        {
+            if (t == table->n_max)
+            { // the identity matrix already has n_max columns
+                set_identity_row(row, t);
+            }
+            row->n = table->n_max;
+            table->numCFFs = t + 1;
+            return true;
+        }
+    }
+    return true;
+}
+
+// the tables for bounds within the embedded ones, or NULL if they have to be built
+static cff_table_ctx_t* cut_embedded_tables(int d_maximum, int t_maximum, long long n_maximum)
+{
+    if (d_maximum < 1 || d_maximum > cff_embedded_num_tables + 1) return NULL;
+    if (t_maximum < 1 || n_maximum > CFF_EMBEDDED_N_MAX) return NULL;
+    cff_table_ctx_t *ctx = malloc(sizeof(cff_table_ctx_t));
+    ctx->d_max = 1;
+    ctx->t_max = t_maximum;
+    ctx->n_max = n_maximum;
+    ctx->tables_array = malloc(sizeof(cff_table_t*) * d_maximum);
+    ctx->tables_array[0] = makeSpernerTable();
+    for (int cff_d = 2; cff_d < d_maximum+1; cff_d++)
+    {
+        cff_table_t *table = initializeTable(t_maximum+1, cff_d, n_maximum);
+        table->num_loops_when_creating = 1;
+        ctx->tables_array[ctx->d_max++] = table;
+        if (!cut_embedded_table(table, t_maximum))
+        {
+            cff_table_free(ctx);
+            return NULL;
+        }
+    }
+    return ctx;
+}
+
 cff_table_ctx_t* cff_table_create(int d_maximum, int t_maximum, long long n_maximum)
 {
     // save memory:
@@ -285,6 +660,13 @@ cff_table_ctx_t* cff_table_create(int d_maximum, int t_maximum, long long n_maxi
         t_maximum = n_maximum;
     }
 
+    // bounds within the tables linked into the library need no building
+    cff_table_ctx_t *embedded = cut_embedded_tables(d_maximum, t_maximum, n_maximum);
+    if (embedded != NULL)
+    {
+        return embedded;
+    }
+
     // setup tables ctx
     // the tables ctx stores an array of pointers to each table, and
     // also stores the max d, t, and n allowed in the tables
@@ -294,55 +676,93 @@ cff_table_ctx_t* cff_table_create(int d_maximum, int t_maximum, long long n_maxi
     ctx->n_max = n_maximum;
     ctx->tables_array = malloc(sizeof(cff_table_t*) * d_maximum);
 
-    // create an array of booleans to determine if numbers are prime
-    bool *prime_array = malloc(sizeof(bool)*t_maximum + 1);
-    prime_sieve(t_maximum, prime_array);
-
-    // each table is stored in this array of pointers to structs, where each struct is one table
-
     // best 1-CFFs are sperner systems, make these seperately
     ctx->tables_array[0] = makeSpernerTable();
 
-    // 2-CFFs have more constructions, so handle it seperately
-    int c = 0;
-    if (d_maximum > 1)
+    // tables for d=2 ... d_max, built from their first recursive row on
+    int *first_row = malloc(sizeof(int) * (d_maximum + 1));
+    for (int cff_d = 2; cff_d < d_maximum+1; cff_d++)
     {
-        ctx->tables_array[1] = initializeTable(t_maximum+1, 2, n_maximum);
-        cff_table_add_fixed_cffs(ctx);
-        cff_table_add_sts_cffs(ctx, t_maximum);
-        cff_table_add_reed_solomon_cffs(ctx, 2, t_maximum, prime_array);
-        cff_table_add_porat_rothschild_cffs(ctx, 2, t_maximum, prime_array);
-        ctx->tables_array[1]->hasBeenChanged = true;
-        while(ctx->tables_array[1]->hasBeenChanged)
-        {
-            c++;
-            ctx->tables_array[1]->hasBeenChanged = false;
-            cff_table_add_doubling_cffs(ctx);
-            cff_table_add_ext_by_one_cffs(ctx, 2);
-            cff_table_add_pair_constructed_cffs(ctx, 2);
-        }
-        ctx->tables_array[1]->num_loops_when_creating = c;
+        ctx->tables_array[cff_d-1] = initializeTable(t_maximum+1, cff_d, n_maximum);
+        first_row[cff_d] = cff_d + 1;
+    }
+    build_rows(ctx, first_row);
+    free(first_row);
+    return ctx;
+}
+
+// grows a table to larger bounds and resets the rows they can change, returns the first of these
+// or -1 if there are none
+static int extend_table(cff_table_t *table, int t_maximum, long long n_maximum)
+{
+    // the rows below n_max are final for any bounds (see cut_embedded_table()), so only the row
+    // where the table stopped at n_max can change, and the rows after it
+    int last = table->numCFFs - 1;
+    int first = table->array[last].n >= table->n_max ? last : last + 1;
+    bool stopped = first == last;
+    if ((stopped && n_maximum == table->n_max) || (!stopped && first > t_maximum))
+    {
+        table->n_max = n_maximum;
+        return -1;
+    }
+    cff_table_row_t *array = realloc(table->array, sizeof(cff_table_row_t) * (t_maximum + 2));
+    if (array == NULL)
+    {
+        printf("realloc fail'd table->array in extend_table\n");
+        exit(1);
     }
+    table->array = array;
+    for (int t = first; t < t_maximum + 2; t++)
+    {
+        set_identity_row(&table->array[t], t);
+    }
+    table->numCFFs = t_maximum + 1;
+    table->n_max = n_maximum;
+    return first;
+}
+
+int cff_table_extend(cff_table_ctx_t *ctx, int d_maximum, int t_maximum, long long n_maximum)
+{
+    if (ctx == NULL) return -1;
+    // the bounds only grow
+    if (d_maximum < ctx->d_max) d_maximum = ctx->d_max;
+    if (n_maximum < ctx->n_max) n_maximum = ctx->n_max;
+    if (t_maximum > n_maximum) t_maximum = n_maximum;
+    if (t_maximum < ctx->t_max) t_maximum = ctx->t_max;
+    if (d_maximum == ctx->d_max && t_maximum == ctx->t_max && n_maximum == ctx->n_max) return 0;
 
-    //tables for d=3 ... d_max
-    for (int cff_d = 3; cff_d < d_maximum+1; cff_d++)
+    // bounds within the tables linked into the library need no building
+    cff_table_ctx_t *embedded = cut_embedded_tables(d_maximum, t_maximum, n_maximum);
+    if (embedded != NULL)
     {
-        ctx->tables_array[cff_d-1] = initializeTable(t_maximum+1, cff_d, n_maximum);
-        cff_table_add_reed_solomon_cffs(ctx, cff_d, t_maximum, prime_array);
-        cff_table_add_porat_rothschild_cffs(ctx, cff_d, t_maximum, prime_array);
-        ctx->tables_array[cff_d-1]->hasBeenChanged = true;
-        c = 0;
-        while(ctx->tables_array[cff_d-1]->hasBeenChanged)
+        cff_table_ctx_t old = *ctx;
+        *ctx = *embedded;
+        *embedded = old;
+        cff_table_free(embedded);
+        return 0;
+    }
+
+    cff_table_t **tables_array = realloc(ctx->tables_array, sizeof(cff_table_t*) * d_maximum);
+    if (tables_array == NULL) return -1;
+    ctx->tables_array = tables_array;
+    int *first_row = malloc(sizeof(int) * (d_maximum + 1));
+    for (int cff_d = 2; cff_d < d_maximum+1; cff_d++)
+    {
+        if (cff_d <= ctx->d_max)
+        {
+            first_row[cff_d] = extend_table(ctx->tables_array[cff_d-1], t_maximum, n_maximum);
+        } else
         {
-            c++;
-            ctx->tables_array[cff_d-1]->hasBeenChanged = false;
-            cff_table_add_ext_by_one_cffs(ctx, cff_d);
-            cff_table_add_pair_constructed_cffs(ctx, cff_d);
+            ctx->tables_array[cff_d-1] = initializeTable(t_maximum+1, cff_d, n_maximum);
+            first_row[cff_d] = cff_d + 1;
         }
-        ctx->tables_array[cff_d-1]->num_loops_when_creating = c;
     }
-    free(prime_array);
-    return ctx;
+    ctx->d_max = d_maximum;
+    ctx->t_max = t_maximum;
+    ctx->n_max = n_maximum;
+    build_rows(ctx, first_row);
+    free(first_row);
+    return 0;
 }
 
 void cff_table_free(cff_table_ctx_t *ctx)
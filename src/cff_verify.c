@@ -0,0 +1,1360 @@
+#include "../include/libcfftables/libcfftables.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+
+#include "cff_internals.h"
+#include "constructions/construction_internals.h"
+
+// if true, when running cff_verify(), it will print out which rows in
+// the CFF the d+1 rows of the ID matrix are found on
+#define CFF_VERIFY_VERBOSE_PRINTOUT false
+
+/*
+    Specialized verification kernels for d = 1, 2, 3.
+
+    A (d+1)-subset of columns is cover-free when every column in it has a
+    "private" row: a 1 that is not in the union of the other d columns. With
+    the columns packed into 64-bit words (cff_pack_columns()), that is one
+    AND-NOT per word, so the kernels never touch individual cells.
+
+    Each kernel is written once as a macro and instantiated twice: with
+    WORDS = 1, so for t <= 64 every column and union is a single register and
+    the word loops disappear, and with WORDS = w for taller matrices. The
+    unions are rebuilt per word inside the innermost loop instead of being
+    stored, so in the one word case the compiler hoists them into registers.
+*/
+
+// d = 1: the columns must form an antichain (no column contains another)
+#define DEFINE_VERIFY_D1_KERNEL(name, WORDS)                                \
+static bool name(const uint64_t *cols, int w, int n)                        \
+{                                                                           \
+    (void) w;                                                               \
+    const int W = (WORDS);                                                  \
+    for (int a = 0; a < n - 1; a++)                                         \
+    {                                                                       \
+        const uint64_t *A = cols + (long long) a * W;                       \
+        for (int b = a + 1; b < n; b++)                                     \
+        {                                                                   \
+            const uint64_t *B = cols + (long long) b * W;                   \
+            uint64_t pa = 0, pb = 0;                                        \
+            for (int i = 0; i < W; i++)                                     \
+            {                                                               \
+                pa |= A[i] & ~B[i];                                         \
+                pb |= B[i] & ~A[i];                                         \
+            }                                                               \
+            if (!pa || !pb) return false;                                   \
+        }                                                                   \
+    }                                                                       \
+    return true;                                                            \
+}
+
+// d = 2: every triple a < b < c
+#define DEFINE_VERIFY_D2_KERNEL(name, WORDS)                                \
+static bool name(const uint64_t *cols, int w, int n)                        \
+{                                                                           \
+    (void) w;                                                               \
+    const int W = (WORDS);                                                  \
+    for (int a = 0; a < n - 2; a++)                                         \
+    {                                                                       \
+        const uint64_t *A = cols + (long long) a * W;                       \
+        for (int b = a + 1; b < n - 1; b++)                                 \
+        {                                                                   \
+            const uint64_t *B = cols + (long long) b * W;                   \
+            for (int c = b + 1; c < n; c++)                                 \
+            {                                                               \
+                const uint64_t *C = cols + (long long) c * W;               \
+                uint64_t pa = 0, pb = 0, pc = 0;                            \
+                for (int i = 0; i < W; i++)                                 \
+                {                                                           \
+                    uint64_t ab = A[i] | B[i];                              \
+                    pc |= C[i] & ~ab;                                       \
+                    pb |= B[i] & ~(A[i] | C[i]);                            \
+                    pa |= A[i] & ~(B[i] | C[i]);                            \
+                }                                                           \
+                if (!pa || !pb || !pc) return false;                        \
+            }                                                               \
+        }                                                                   \
+    }                                                                       \
+    return true;                                                            \
+}
+
+// d = 3: every quadruple a < b < c < e
+#define DEFINE_VERIFY_D3_KERNEL(name, WORDS)                                \
+static bool name(const uint64_t *cols, int w, int n)                        \
+{                                                                           \
+    (void) w;                                                               \
+    const int W = (WORDS);                                                  \
+    for (int a = 0; a < n - 3; a++)                                         \
+    {                                                                       \
+        const uint64_t *A = cols + (long long) a * W;                       \
+        for (int b = a + 1; b < n - 2; b++)                                 \
+        {                                                                   \
+            const uint64_t *B = cols + (long long) b * W;                   \
+            for (int c = b + 1; c < n - 1; c++)                             \
+            {                                                               \
+                const uint64_t *C = cols + (long long) c * W;               \
+                for (int e = c + 1; e < n; e++)                             \
+                {                                                           \
+                    const uint64_t *E = cols + (long long) e * W;           \
+                    uint64_t pa = 0, pb = 0, pc = 0, pe = 0;                \
+                    for (int i = 0; i < W; i++)                             \
+                    {                                                       \
+                        uint64_t ab = A[i] | B[i];                          \
+                        uint64_t ce = C[i] | E[i];                          \
+                        pe |= E[i] & ~(ab | C[i]);                          \
+                        pc |= C[i] & ~(ab | E[i]);                          \
+                        pb |= B[i] & ~(A[i] | ce);                          \
+                        pa |= A[i] & ~(B[i] | ce);                          \
+                    }                                                       \
+                    if (!pa || !pb || !pc || !pe) return false;             \
+                }                                                           \
+            }                                                               \
+        }                                                                   \
+    }                                                                       \
+    return true;                                                            \
+}
+
+DEFINE_VERIFY_D1_KERNEL(verify_d1_one_word, 1)
+DEFINE_VERIFY_D1_KERNEL(verify_d1_words, w)
+DEFINE_VERIFY_D2_KERNEL(verify_d2_one_word, 1)
+DEFINE_VERIFY_D2_KERNEL(verify_d2_words, w)
+DEFINE_VERIFY_D3_KERNEL(verify_d3_one_word, 1)
+DEFINE_VERIFY_D3_KERNEL(verify_d3_words, w)
+
+// picks the kernel for a packed CFF with 1 <= d <= 3
+static bool verify_packed(const uint64_t *cols, int w, int n, int d)
+{
+    switch (d)
+    {
+    case 1:
+        return w == 1 ? verify_d1_one_word(cols, w, n) : verify_d1_words(cols, w, n);
+    case 2:
+        return w == 1 ? verify_d2_one_word(cols, w, n) : verify_d2_words(cols, w, n);
+    default:
+        return w == 1 ? verify_d3_one_word(cols, w, n) : verify_d3_words(cols, w, n);
+    }
+}
+
+// cell by cell check of every (d+1)-subset of columns, for any d
+static bool verify_generic(const cff_t *cff)
+{
+    // cols will be an array of columns of size d+1 to test
+    int k = cff->d + 1;
+    int cols[k];
+    for (int i = 0; i < k; i++)
+    { // set cols to the smallest lexicographic ordering
+        cols[i] = i;
+    }
+
+    do
+    {
+        if (CFF_VERIFY_VERBOSE_PRINTOUT)
+        { //print out the current columns that are being tested
+            printf("Testing cols:  ");
+            for (int x = 0; x < k; x++)
+            {
+                printf("%u  ", cols[x]);
+            }
+            printf("| ID Matrix found on rows:  ");
+        }
+
+        // verify array "v". keeps track of the first i.d. row for every col in "cols"  array
+        int v[k];
+        for (int x = 0; x < k; x++)
+        {
+            v[x] = -1;
+        }
+
+        // s is sum of the current row, e will be the most recent column where a 1 was seen
+        int s, e;
+        // f is the number of identity rows found so far (for this particular subset of columns)
+        int f = 0;
+        // iterate over the rows in the cff
+        for (int r = 0; r < cff->t; r++)
+        {
+            // iterate over the subset of columns we are currently testing
+            s = 0;
+            for (int c = 0; c < k; c++)
+            {
+                // if the current cell is 1:
+                if (cff_get_matrix_value(cff, r, cols[c]) == 1)
+                { // record the position of the column and increment row sum
+                    e = c;
+                    s++;
+                }
+            }
+            // check if the row was the first identity row for its column with a 1
+            if (s == 1 && v[e] == -1)
+            {
+                if (CFF_VERIFY_VERBOSE_PRINTOUT) { printf("%u  ", r); }
+                // record that c's identity row exists (by saving the row index)
+                v[e] = (int) r;
+                f++;
+                if (f == k)
+                { // exit early if all identity rows are found
+                    break;
+                }
+
+            }
+        }
+
+        // now return false if any of the identity rows were not there
+        if (f != k)
+        {
+            if (CFF_VERIFY_VERBOSE_PRINTOUT) { printf(" Some ID rows not found! CFF is invalid\n"); }
+            return false;
+        }
+        if (CFF_VERIFY_VERBOSE_PRINTOUT) { printf("\n"); }
+    } while (k_subset_lex_successor(cff->n, k, cols));
+    return true;
+}
+
+// returns true if the CFF is a valid cover free family.
+// returns false otherwise.
+bool cff_verify(const cff_t *cff)
+{
+    if (cff->d+1 > cff->n)
+    { // return false if the parameters are invalid
+        return false;
+    }
+
+    // CFFs from the tables know their construction, and so their symmetries
+    // (which still go through the kernels below for d <= 3 when they don't cut enough subsets)
+    if (cff->recipe != NULL && !CFF_VERIFY_VERBOSE_PRINTOUT)
+    {
+        return cff_verify_with_symmetry(cff, NULL, 0);
+    }
+
+    // the common small d cases go through the packed kernels, falling back to
+    // the generic check if the packed copy can't be allocated
+    if (cff->d >= 1 && cff->d <= 3 && !CFF_VERIFY_VERBOSE_PRINTOUT)
+    {
+        int w;
+        uint64_t *cols = cff_pack_columns(cff, &w);
+        if (cols != NULL)
+        {
+            bool result = verify_packed(cols, w, (int) cff->n, cff->d);
+            free(cols);
+            return result;
+        }
+    }
+    return verify_generic(cff);
+}
+
+/*
+    Resumable verification.
+
+    cff_verify_ex() walks the (d+1)-subsets of columns in lexicographic order
+    in chunks of checkpoint_interval subsets. Between chunks it reports
+    progress, polls the cancellation flag and writes the cursor (the next
+    subset to check) to the checkpoint file, so a killed run picks up from
+    the last chunk. The checkpoint records a hash of the packed columns, so
+    it is never resumed against a different matrix.
+*/
+
+#define CFF_VERIFY_DEFAULT_CHECKPOINT_INTERVAL (1LL << 22)
+#define CFF_VERIFY_CHECKPOINT_HEADER "libcfftables-verify-checkpoint 1"
+
+// FNV-1a over the packed columns (which, unlike the matrix, have no bits past n)
+static uint64_t packed_columns_hash(const uint64_t *cols, int w, long long n)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (long long i = 0; i < n * w; i++)
+    {
+        hash ^= cols[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// returns the index (in the subset) of a column with no private row, or -1
+// if the subset is cover free. prefix/suffix are scratch arrays of k+1 words
+static int packed_subset_uncovered(const uint64_t *cols, int w, const int *subset, int k,
+                                   uint64_t *prefix, uint64_t *suffix)
+{
+    uint64_t found[k];
+    for (int i = 0; i < k; i++) found[i] = 0;
+    for (int x = 0; x < w; x++)
+    {
+        prefix[0] = 0;
+        suffix[k] = 0;
+        for (int i = 0; i < k; i++)
+        {
+            prefix[i+1] = prefix[i] | cols[(long long) subset[i] * w + x];
+            suffix[k-1-i] = suffix[k-i] | cols[(long long) subset[k-1-i] * w + x];
+        }
+        for (int i = 0; i < k; i++)
+        {
+            found[i] |= cols[(long long) subset[i] * w + x] & ~(prefix[i] | suffix[i+1]);
+        }
+    }
+    for (int i = 0; i < k; i++)
+    {
+        if (!found[i]) return i;
+    }
+    return -1;
+}
+
+// reads the cursor from a checkpoint file. returns false (and leaves the
+// cursor alone) if there is no usable checkpoint for this matrix
+static bool read_checkpoint(const char *path, const cff_t *cff, uint64_t hash,
+                            int *subset, long long *checked)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return false;
+    char header[64];
+    int t, d;
+    long long n, stored_checked;
+    unsigned long long stored_hash;
+    bool ok = fgets(header, sizeof(header), f) != NULL
+        && strncmp(header, CFF_VERIFY_CHECKPOINT_HEADER, strlen(CFF_VERIFY_CHECKPOINT_HEADER)) == 0
+        && fscanf(f, "%d %lld %d %llu %lld", &t, &n, &d, &stored_hash, &stored_checked) == 5
+        && t == cff->t && n == cff->n && d == cff->d && stored_hash == hash;
+    int k = cff->d + 1;
+    int stored[k];
+    for (int i = 0; ok && i < k; i++)
+    {
+        ok = fscanf(f, "%d", &stored[i]) == 1 && stored[i] >= 0 && stored[i] < n
+            && (i == 0 || stored[i] > stored[i-1]);
+    }
+    fclose(f);
+    if (!ok) return false;
+    for (int i = 0; i < k; i++) subset[i] = stored[i];
+    *checked = stored_checked;
+    return true;
+}
+
+// writes the cursor to path + ".tmp" and renames it over path, so a run
+// killed while writing leaves the previous checkpoint intact
+static bool write_checkpoint(const char *path, const cff_t *cff, uint64_t hash,
+                             const int *subset, long long checked)
+{
+    size_t len = strlen(path);
+    char tmp_path[len + 5];
+    memcpy(tmp_path, path, len);
+    memcpy(tmp_path + len, ".tmp", 5);
+    FILE *f = fopen(tmp_path, "w");
+    if (f == NULL) return false;
+    fprintf(f, "%s\n%d %lld %d %llu %lld\n", CFF_VERIFY_CHECKPOINT_HEADER,
+        cff->t, cff->n, cff->d, (unsigned long long) hash, checked);
+    for (int i = 0; i < cff->d + 1; i++)
+    {
+        fprintf(f, "%d ", subset[i]);
+    }
+    fprintf(f, "\n");
+    bool ok = fclose(f) == 0 && rename(tmp_path, path) == 0;
+    if (!ok) remove(tmp_path);
+    return ok;
+}
+
+cff_verify_status_t cff_verify_ex(const cff_t *cff, const cff_verify_options_t *options,
+                                  long long *witness, long long *uncovered)
+{
+    if (cff == NULL || cff->d < 1) return CFF_VERIFY_ERROR;
+    if (cff->d + 1 > cff->n) return CFF_VERIFY_INVALID;
+    cff_verify_options_t defaults = {0};
+    if (options == NULL) options = &defaults;
+    long long interval = options->checkpoint_interval > 0
+        ? options->checkpoint_interval : CFF_VERIFY_DEFAULT_CHECKPOINT_INTERVAL;
+
+    int w;
+    uint64_t *cols = cff_pack_columns(cff, &w);
+    if (cols == NULL) return CFF_VERIFY_ERROR;
+    uint64_t hash = packed_columns_hash(cols, w, cff->n);
+
+    int k = cff->d + 1;
+    int n = (int) cff->n;
+    int subset[k];
+    for (int i = 0; i < k; i++) subset[i] = i;
+    long long checked = 0;
+    if (options->checkpoint_path != NULL)
+    {
+        read_checkpoint(options->checkpoint_path, cff, hash, subset, &checked);
+    }
+    long long total = choose(n, k); // 0 if it doesn't fit in a long long
+
+    uint64_t prefix[k + 1], suffix[k + 1];
+    cff_verify_status_t status = CFF_VERIFY_VALID;
+    bool more = true;
+    while (more)
+    {
+        // one chunk of subsets
+        for (long long i = 0; i < interval && more; i++)
+        {
+            int bad = packed_subset_uncovered(cols, w, subset, k, prefix, suffix);
+            if (bad >= 0)
+            {
+                if (witness != NULL)
+                {
+                    for (int j = 0; j < k; j++) witness[j] = subset[j];
+                }
+                if (uncovered != NULL) *uncovered = subset[bad];
+                status = CFF_VERIFY_INVALID;
+                more = false;
+                break;
+            }
+            checked++;
+            more = k_subset_lex_successor(n, k, subset);
+        }
+        if (options->progress != NULL)
+        {
+            options->progress(checked, total, options->user_data);
+        }
+        if (!more) break;
+        if (options->checkpoint_path != NULL
+            && !write_checkpoint(options->checkpoint_path, cff, hash, subset, checked))
+        {
+            status = CFF_VERIFY_CHECKPOINT_FAILED;
+            break;
+        }
+        if (options->cancel != NULL && *options->cancel)
+        {
+            status = CFF_VERIFY_CANCELLED;
+            break;
+        }
+    }
+    if ((status == CFF_VERIFY_VALID || status == CFF_VERIFY_INVALID) && options->checkpoint_path != NULL)
+    { // a finished run has nothing to resume
+        remove(options->checkpoint_path);
+    }
+    free(cols);
+    return status;
+}
+
+/*
+    Symmetry reduced verification.
+
+    Whether a subset of columns is cover free doesn't change when an
+    automorphism (a column permutation that maps the rows onto the rows) is
+    applied to it. So with the columns split into orbits O_0, O_1, ... of the
+    group generated by some automorphisms, ordered by their smallest columns
+    r_0 < r_1 < ..., every (d+1)-subset can be moved onto one that contains
+    r_j, where O_j is the first orbit the subset meets, and d other columns
+    from the orbits O_j, O_j+1, .... Only those subsets are checked; when the
+    group is transitive, that is the C(n-1, d) subsets containing column 0.
+    For d <= 3 the kernels above run through all subsets many times faster
+    per subset, so the representatives are only used when the orbits cut
+    the number of subsets by more than that.
+
+    Generators are never trusted: each is checked to really be an
+    automorphism before its orbits are merged, so a wrong generator can only
+    cost speed, not soundness.
+*/
+
+#define CFF_VERIFY_MAX_GENERATORS 256
+
+// how many times faster a d <= 3 kernel checks a subset than packed_subset_uncovered()
+// (measured 12 to 27 times on Reed-Solomon CFFs)
+#define CFF_VERIFY_KERNEL_SPEEDUP 16
+
+typedef struct perm_list
+{
+    int length; // of each permutation
+    int count;
+    int capacity;
+    int *perms; // count * length entries
+} perm_list_t;
+
+static bool perm_list_add(perm_list_t *list, const int *perm)
+{
+    if (list->count == CFF_VERIFY_MAX_GENERATORS) return true; // enough
+    if (list->count == list->capacity)
+    {
+        int capacity = list->capacity ? list->capacity * 2 : 8;
+        int *perms = realloc(list->perms, (size_t) capacity * list->length * sizeof(int));
+        if (perms == NULL) return false;
+        list->perms = perms;
+        list->capacity = capacity;
+    }
+    int *dest = list->perms + (long long) list->count * list->length;
+    for (int i = 0; i < list->length; i++) dest[i] = perm[i];
+    list->count++;
+    return true;
+}
+
+// the cyclic shift r -> r+1 of t rows
+static bool add_cyclic_shift(perm_list_t *list)
+{
+    int perm[list->length];
+    for (int r = 0; r < list->length; r++) perm[r] = (r + 1) % list->length;
+    return perm_list_add(list, perm);
+}
+
+// adds the row permutations that come from construction's symmetries to list
+// (of length node->t). children's permutations are lifted into the rows they
+// occupy in the result
+static bool add_recipe_row_automorphisms(const cff_recipe_t *node, perm_list_t *list)
+{
+    const short *p = node->consParams;
+    int *perms = NULL;
+    int count = 0;
+    switch (node->constructionID)
+    {
+    case CFF_CONSTRUCTION_ID_IDENTITY_MATRIX:
+    case CFF_CONSTRUCTION_ID_SPERNER:
+        // permuting the points maps the (t/2)-subsets (or singletons) onto themselves
+        return add_cyclic_shift(list);
+    case CFF_CONSTRUCTION_ID_STS:
+        count = sts_row_automorphisms(p[0], &perms);
+        break;
+    case CFF_CONSTRUCTION_ID_REED_SOLOMON:
+        count = reed_solomon_row_automorphisms(p[0], p[1], p[2], p[3], &perms);
+        break;
+    case CFF_CONSTRUCTION_ID_EXT_BY_ONE:
+    case CFF_CONSTRUCTION_ID_ADDITIVE:
+    case CFF_CONSTRUCTION_ID_KRONECKER: {
+        int perm[node->t];
+        for (int i = 0; i < node->num_children; i++)
+        {
+            const cff_recipe_t *child = node->children[i];
+            perm_list_t child_list = {child->t, 0, 0, NULL};
+            if (!add_recipe_row_automorphisms(child, &child_list))
+            {
+                free(child_list.perms);
+                return false;
+            }
+            for (int g = 0; g < child_list.count; g++)
+            {
+                const int *sigma = child_list.perms + (long long) g * child->t;
+                if (node->constructionID == CFF_CONSTRUCTION_ID_KRONECKER)
+                { // row = right row * left t + left row
+                    int left_t = node->children[0]->t;
+                    for (int r = 0; r < node->t; r++)
+                    {
+                        perm[r] = i == 0 ? (r / left_t) * left_t + sigma[r % left_t]
+                                         : sigma[r / left_t] * left_t + r % left_t;
+                    }
+                }
+                else
+                { // block diagonal: the child's rows start at offset
+                    int offset = i == 0 ? 0 : node->children[0]->t;
+                    for (int r = 0; r < node->t; r++)
+                    {
+                        bool in_child = r >= offset && r < offset + child->t;
+                        perm[r] = in_child ? offset + sigma[r - offset] : r;
+                    }
+                }
+                if (!perm_list_add(list, perm))
+                {
+                    free(child_list.perms);
+                    return false;
+                }
+            }
+            free(child_list.perms);
+        }
+        return true;
+    }
+    default:
+        return true; // no known symmetries
+    }
+    if (count < 0) return false;
+    bool ok = true;
+    for (int g = 0; g < count && ok; g++)
+    {
+        ok = perm_list_add(list, perms + (long long) g * node->t);
+    }
+    free(perms);
+    return ok;
+}
+
+typedef struct hashed_index
+{
+    uint64_t hash;
+    int index;
+} hashed_index_t;
+
+static int compare_hashed_index(const void *a, const void *b)
+{
+    const hashed_index_t *x = a, *y = b;
+    if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+    return x->index - y->index;
+}
+
+static uint64_t words_hash(const uint64_t *words, int w)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < w; i++)
+    {
+        hash ^= words[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// sorted (hash, index) pairs of count vectors of w words, for find_vector()
+static hashed_index_t* index_vectors(const uint64_t *vectors, int count, int w)
+{
+    hashed_index_t *sorted = malloc((size_t) count * sizeof(hashed_index_t));
+    if (sorted == NULL) return NULL;
+    for (int i = 0; i < count; i++)
+    {
+        sorted[i].hash = words_hash(vectors + (long long) i * w, w);
+        sorted[i].index = i;
+    }
+    qsort(sorted, count, sizeof(hashed_index_t), compare_hashed_index);
+    return sorted;
+}
+
+// the index of an unused vector equal to target, or -1 if there is none
+static int find_vector(const hashed_index_t *sorted, int count, const uint64_t *vectors, int w,
+                       const uint64_t *target, const bool *used)
+{
+    uint64_t hash = words_hash(target, w);
+    int lo = 0, hi = count;
+    while (lo < hi)
+    { // first entry with this hash
+        int mid = lo + (hi - lo) / 2;
+        if (sorted[mid].hash < hash) lo = mid + 1;
+        else hi = mid;
+    }
+    for (int i = lo; i < count && sorted[i].hash == hash; i++)
+    {
+        int v = sorted[i].index;
+        if (!used[v] && memcmp(vectors + (long long) v * w, target, w * sizeof(uint64_t)) == 0)
+        {
+            return v;
+        }
+    }
+    return -1;
+}
+
+// the column permutation a row permutation induces, if it maps the columns onto
+// the columns. returns false (column_perm is garbage) otherwise
+static bool row_perm_to_column_perm(const uint64_t *cols, int w, int n, int t,
+                                    const hashed_index_t *sorted_cols, const int *row_perm,
+                                    long long *column_perm, bool *used)
+{
+    for (int c = 0; c < n; c++) used[c] = false;
+    uint64_t image[w];
+    for (int c = 0; c < n; c++)
+    {
+        for (int i = 0; i < w; i++) image[i] = 0;
+        for (int i = 0; i < w; i++)
+        {
+            uint64_t word = cols[(long long) c * w + i];
+            while (word)
+            {
+                int r = i * 64 + lowest_bit64(word);
+                int to = row_perm[r];
+                if (to < 0 || to >= t) return false;
+                image[to / 64] |= (uint64_t) 1 << (to % 64);
+                word &= word - 1;
+            }
+        }
+        int found = find_vector(sorted_cols, n, cols, w, image, used);
+        if (found < 0) return false;
+        used[found] = true;
+        column_perm[c] = found;
+    }
+    return true;
+}
+
+// true if the column permutation maps the rows onto the rows
+static bool is_column_automorphism(const uint64_t *cols, int w, int n, int t,
+                                   const long long *column_perm, bool *used)
+{
+    // transpose into packed rows
+    int rw = (n + 63) / 64;
+    uint64_t *rows = calloc((size_t) t * rw, sizeof(uint64_t));
+    uint64_t *images = calloc((size_t) t * rw, sizeof(uint64_t));
+    bool *seen = calloc(n, sizeof(bool));
+    bool valid = rows != NULL && images != NULL && seen != NULL;
+    for (int c = 0; c < n && valid; c++)
+    { // it must be a permutation
+        long long to = column_perm[c];
+        valid = to >= 0 && to < n && !seen[to];
+        if (valid) seen[to] = true;
+    }
+    for (int c = 0; c < n && valid; c++)
+    {
+        long long to = column_perm[c];
+        for (int i = 0; i < w; i++)
+        {
+            uint64_t word = cols[(long long) c * w + i];
+            while (word)
+            {
+                int r = i * 64 + lowest_bit64(word);
+                rows[(long long) r * rw + c / 64] |= (uint64_t) 1 << (c % 64);
+                images[(long long) r * rw + to / 64] |= (uint64_t) 1 << (to % 64);
+                word &= word - 1;
+            }
+        }
+    }
+    hashed_index_t *sorted_rows = valid ? index_vectors(rows, t, rw) : NULL;
+    valid = valid && sorted_rows != NULL;
+    for (int r = 0; r < t && valid; r++) used[r] = false;
+    for (int r = 0; r < t && valid; r++)
+    {
+        int found = find_vector(sorted_rows, t, rows, rw, images + (long long) r * rw, used);
+        valid = found >= 0;
+        if (valid) used[found] = true;
+    }
+    free(sorted_rows);
+    free(rows);
+    free(images);
+    free(seen);
+    return valid;
+}
+
+static int find_root(int *parent, int c)
+{
+    while (parent[c] != c)
+    {
+        parent[c] = parent[parent[c]];
+        c = parent[c];
+    }
+    return c;
+}
+
+static void merge_orbits(int *parent, const long long *column_perm, int n)
+{
+    for (int c = 0; c < n; c++)
+    {
+        int a = find_root(parent, c), b = find_root(parent, (int) column_perm[c]);
+        if (a != b)
+        {
+            if (a < b) parent[b] = a; // keep the smallest column as the root
+            else parent[a] = b;
+        }
+    }
+}
+
+// splits the packed columns into the orbits of the generators that really are automorphisms (or
+// of the construction's, without generators). orbit_of[c] is the orbit of column c, numbered in
+// the order of their smallest columns, which go to reps. returns the number of orbits, or -1 if
+// out of memory
+static int column_orbits(const cff_t *cff, const uint64_t *cols, int w,
+                         const long long *generators, int num_generators, int *orbit_of, int *reps)
+{
+    int n = (int) cff->n, t = cff->t;
+    // parent is a union-find forest over the columns, rooted at the smallest column of each orbit
+    int *parent = malloc((size_t) n * sizeof(int));
+    long long *column_perm = malloc((size_t) n * sizeof(long long));
+    bool *used = malloc((size_t) (n > t ? n : t) * sizeof(bool));
+    if (parent == NULL || column_perm == NULL || used == NULL)
+    {
+        free(parent);
+        free(column_perm);
+        free(used);
+        return -1;
+    }
+    for (int c = 0; c < n; c++) parent[c] = c;
+
+    for (int g = 0; g < num_generators; g++)
+    {
+        const long long *perm = generators + (long long) g * n;
+        if (is_column_automorphism(cols, w, n, t, perm, used))
+        {
+            merge_orbits(parent, perm, n);
+        }
+    }
+    if (num_generators <= 0 && cff->recipe != NULL && cff->recipe->t == t)
+    {
+        perm_list_t rows = {t, 0, 0, NULL};
+        hashed_index_t *sorted_cols = index_vectors(cols, n, w);
+        if (sorted_cols != NULL && add_recipe_row_automorphisms(cff->recipe, &rows))
+        {
+            for (int g = 0; g < rows.count; g++)
+            {
+                const int *row_perm = rows.perms + (long long) g * t;
+                if (row_perm_to_column_perm(cols, w, n, t, sorted_cols, row_perm, column_perm, used))
+                {
+                    merge_orbits(parent, column_perm, n);
+                }
+            }
+        }
+        free(rows.perms);
+        free(sorted_cols);
+    }
+
+    int num_orbits = 0;
+    for (int c = 0; c < n; c++)
+    {
+        int root = find_root(parent, c);
+        if (root == c)
+        {
+            reps[num_orbits] = c;
+            orbit_of[c] = num_orbits++;
+        }
+        else
+        {
+            orbit_of[c] = orbit_of[root];
+        }
+    }
+    free(parent);
+    free(column_perm);
+    free(used);
+    return num_orbits;
+}
+
+int cff_column_orbits(const cff_t *cff, const long long *generators, int num_generators, int *orbit_of)
+{
+    if (cff == NULL || cff->n < 1 || cff->n > INT_MAX) return -1;
+    int n = (int) cff->n, w;
+    uint64_t *cols = cff_pack_columns(cff, &w);
+    int *orbits = malloc((size_t) n * sizeof(int));
+    int *reps = malloc((size_t) n * sizeof(int));
+    int num_orbits = -1;
+    if (cols != NULL && orbits != NULL && reps != NULL)
+    {
+        num_orbits = column_orbits(cff, cols, w, generators, num_generators, orbits, reps);
+        if (num_orbits >= 0 && orbit_of != NULL) memcpy(orbit_of, orbits, (size_t) n * sizeof(int));
+    }
+    free(cols);
+    free(orbits);
+    free(reps);
+    return num_orbits;
+}
+
+// checks the subsets {reps[j]} + d columns from orbits >= j, for every orbit j
+// (eligible is scratch space for n columns)
+static bool verify_orbit_representatives(const uint64_t *cols, int w, int n, int d,
+                                         const int *orbit_of, const int *reps, int num_orbits,
+                                         int *eligible)
+{
+    int k = d + 1;
+    int idx[d], subset[k];
+    uint64_t prefix[k + 1], suffix[k + 1];
+    bool valid = true;
+    for (int j = 0; j < num_orbits && valid; j++)
+    {
+        int count = 0;
+        for (int c = 0; c < n; c++)
+        {
+            if (orbit_of[c] >= j && c != reps[j]) eligible[count++] = c;
+        }
+        if (count < d) continue;
+        subset[0] = reps[j];
+        for (int i = 0; i < d; i++) idx[i] = i;
+        do
+        {
+            for (int i = 0; i < d; i++) subset[i + 1] = eligible[idx[i]];
+            if (packed_subset_uncovered(cols, w, subset, k, prefix, suffix) >= 0)
+            {
+                valid = false;
+                break;
+            }
+        } while (k_subset_lex_successor(count, d, idx));
+    }
+    return valid;
+}
+
+// C(n, k) in floating point, for comparing subset counts that may not fit a long long
+static double binomial(double n, int k)
+{
+    double result = 1;
+    for (int i = 0; i < k; i++) result = result * (n - i) / (i + 1);
+    return n < k ? 0 : result;
+}
+
+// true if the orbit representatives are worth checking instead of running the
+// d <= 3 kernels over every subset, which do a subset many times faster
+static bool orbits_beat_kernels(const int *orbit_of, int n, int d, int num_orbits)
+{
+    if (d > 3) return true;
+    if (num_orbits == n) return false;
+    // orbit j is checked against the columns of orbits >= j, so C(that - 1, d) subsets
+    int *sizes = calloc(num_orbits, sizeof(int));
+    if (sizes == NULL) return false;
+    for (int c = 0; c < n; c++) sizes[orbit_of[c]]++;
+    double representatives = 0, later = n;
+    for (int j = 0; j < num_orbits; j++)
+    {
+        representatives += binomial(later - 1, d);
+        later -= sizes[j];
+    }
+    free(sizes);
+    return representatives * CFF_VERIFY_KERNEL_SPEEDUP < binomial(n, d + 1);
+}
+
+bool cff_verify_with_symmetry(const cff_t *cff, const long long *generators, int num_generators)
+{
+    if (cff == NULL) return false;
+    if (cff->d + 1 > cff->n) return false;
+    if (cff->d < 1) return verify_generic(cff);
+    int n = (int) cff->n, w;
+    uint64_t *cols = cff_pack_columns(cff, &w);
+    if (cols == NULL) return verify_generic(cff);
+
+    int *orbit_of = malloc((size_t) n * sizeof(int));
+    int *reps = malloc((size_t) n * sizeof(int));
+    int *eligible = malloc((size_t) n * sizeof(int));
+    int num_orbits = orbit_of != NULL && reps != NULL && eligible != NULL
+        ? column_orbits(cff, cols, w, generators, num_generators, orbit_of, reps)
+        : -1;
+    bool result;
+    if (num_orbits < 0)
+    {
+        result = verify_generic(cff);
+    }
+    else if (!orbits_beat_kernels(orbit_of, n, cff->d, num_orbits))
+    { // too little symmetry to pay for the slower subset check
+        result = verify_packed(cols, w, n, cff->d);
+    }
+    else
+    {
+        result = verify_orbit_representatives(cols, w, n, cff->d, orbit_of, reps, num_orbits, eligible);
+    }
+    free(orbit_of);
+    free(reps);
+    free(eligible);
+    free(cols);
+    return result;
+}
+
+/*
+    Maximum strength.
+
+    A matrix is a d-CFF exactly when no column is contained in the union of
+    d other columns, so the largest d is one less than the size of the
+    smallest set of columns whose union contains another column x. Such a
+    set covers the rows of x, so for each x the search only looks at x's
+    rows: the other columns that meet them (its neighbours) become bitmasks
+    over those rows. The sets are searched in levels of increasing size, and
+    level s is made from the sets of level s - 1 and their stored unions,
+    each extended by one later neighbour with one OR. A set is only kept if
+    its last column adds rows to the union, since in a smallest cover every
+    column covers a row the others miss, and so does every prefix of it. It
+    is also dropped if the rows it leaves could not be covered below the
+    limit: no neighbour meets more than g of x's rows, so r rows need at
+    least ceil(r / g) more columns. The levels stop at the first cover, and
+    for the next x the limit is the smallest cover found so far.
+
+    The levels can grow like C(neighbours, s), so they are stored in at most
+    COVER_SEARCH_MAX_BYTES. When the next level does not fit, the sets of
+    the last stored level are extended depth first instead, with the unions
+    of one path stacked, and each cover found lowers the limit for the rest
+    of the search.
+*/
+
+// the level search stores at most this many bytes of sets and unions
+#define COVER_SEARCH_MAX_BYTES ((long long) 1 << 20)
+
+// a set of columns in the search for a cover of one column
+typedef struct
+{
+    int last; // the neighbour added last
+    long long parent; // the set it extends, -1 for the empty set
+} cover_set_t;
+
+// buffers for smallest_cover(), kept between columns, and the column being searched
+typedef struct
+{
+    int *rows; // the rows of the column
+    int *neighbours; // the columns that meet them
+    uint64_t *neighbour_masks; // their cells in those rows, kw words each
+    cover_set_t *sets; // the sets of every level so far
+    uint64_t *unions; // their unions, kw words each
+    long long capacity; // sets (and unions) allocated
+    uint64_t *stack; // the unions along the path of the depth first search, kw words each
+    int *path; // the neighbours added along it
+    uint64_t *full; // all the rows of the column
+    int kw; // words of a union
+    int num_neighbours;
+    int gain; // the most rows of the column one neighbour meets
+    int limit; // only covers of fewer columns are looked for
+} cover_search_t;
+
+static bool cover_search_reserve(cover_search_t *search, long long count, int kw)
+{
+    if (count <= search->capacity) return true;
+    long long capacity = search->capacity > 0 ? search->capacity : 1024;
+    while (capacity < count) capacity *= 2;
+    cover_set_t *sets = realloc(search->sets, (size_t) capacity * sizeof(cover_set_t));
+    if (sets == NULL) return false;
+    search->sets = sets;
+    uint64_t *unions = realloc(search->unions, (size_t) capacity * kw * sizeof(uint64_t));
+    if (unions == NULL) return false;
+    search->unions = unions;
+    search->capacity = capacity;
+    return true;
+}
+
+// true if the union u of s columns leaves rows that fewer than limit - s more columns could cover;
+// *covers is set if it leaves none
+static bool worth_extending(const cover_search_t *search, const uint64_t *u, int s, bool *covers)
+{
+    int left = 0;
+    for (int j = 0; j < search->kw; j++) left += popcount64(search->full[j] & ~u[j]);
+    *covers = left == 0;
+    return left > 0 && s + (left + search->gain - 1) / search->gain < search->limit;
+}
+
+// writes the columns of stored set e and then of the first path_length neighbours of the path
+static void write_cover(const cover_search_t *search, long long e, int path_length, int *subset)
+{
+    int size = 0;
+    for (long long p = e; p > 0; p = search->sets[p].parent) size++;
+    for (long long p = e, j = size - 1; p > 0; p = search->sets[p].parent, j--)
+    {
+        subset[j] = search->neighbours[search->sets[p].last];
+    }
+    for (int j = 0; j < path_length; j++) subset[size + j] = search->neighbours[search->path[j]];
+}
+
+// depth first search below a set of s columns whose union is at the given depth of the stack and
+// whose last column is neighbour last, started from stored set e; each cover found lowers the limit
+static void extend_cover_depth_first(cover_search_t *search, long long e, int s, int depth, int last,
+                                     int *subset)
+{
+    int kw = search->kw;
+    const uint64_t *prefix = search->stack + (long long) depth * kw;
+    uint64_t *next = search->stack + (long long) (depth + 1) * kw;
+    for (int i = last + 1; i < search->num_neighbours && s + 1 < search->limit; i++)
+    {
+        const uint64_t *mask = search->neighbour_masks + (long long) i * kw;
+        bool adds = false, covers;
+        for (int j = 0; j < kw; j++)
+        {
+            next[j] = prefix[j] | mask[j];
+            adds |= next[j] != prefix[j];
+        }
+        if (!adds) continue;
+        search->path[depth] = i;
+        if (worth_extending(search, next, s + 1, &covers))
+        {
+            extend_cover_depth_first(search, e, s + 1, depth + 1, i, subset);
+        }
+        else if (covers)
+        {
+            search->limit = s + 1;
+            write_cover(search, e, depth + 1, subset);
+        }
+    }
+}
+
+// the size of the smallest set of other columns whose union contains column x, if it is below
+// limit (subset receives its columns in increasing order); limit if there is none, -1 if out of
+// memory
+static int smallest_cover(const uint64_t *cols, int w, int n, int x, int limit, int *subset,
+                          cover_search_t *search)
+{
+    const uint64_t *col_x = cols + (long long) x * w;
+    int k = 0;
+    for (int i = 0; i < w; i++)
+    {
+        for (uint64_t bits = col_x[i]; bits; bits &= bits - 1)
+        {
+            search->rows[k++] = i * 64 + lowest_bit64(bits);
+        }
+    }
+    int kw = (k + 63) / 64;
+    uint64_t *full = realloc(search->full, kw * sizeof(uint64_t));
+    if (full != NULL) search->full = full;
+    uint64_t *masks = realloc(search->neighbour_masks, (size_t) n * kw * sizeof(uint64_t));
+    if (masks != NULL) search->neighbour_masks = masks;
+    uint64_t *stack = realloc(search->stack, (size_t) (n + 1) * kw * sizeof(uint64_t));
+    if (stack != NULL) search->stack = stack;
+    if (full == NULL || masks == NULL || stack == NULL || !cover_search_reserve(search, 1, kw)) return -1;
+    memset(full, 0, kw * sizeof(uint64_t));
+    for (int j = 0; j < k; j++) full[j / 64] |= (uint64_t) 1 << (j % 64);
+
+    // the neighbours as masks over the rows of x
+    int num_neighbours = 0, gain = 0;
+    for (int c = 0; c < n; c++)
+    {
+        const uint64_t *col = cols + (long long) c * w;
+        uint64_t shared = 0;
+        for (int i = 0; i < w && !shared; i++) shared = col[i] & col_x[i];
+        if (c == x || !shared) continue;
+        uint64_t *mask = masks + (long long) num_neighbours * kw;
+        memset(mask, 0, kw * sizeof(uint64_t));
+        int meets = 0;
+        for (int j = 0; j < k; j++)
+        {
+            if ((col[search->rows[j] / 64] >> (search->rows[j] % 64)) & 1)
+            {
+                mask[j / 64] |= (uint64_t) 1 << (j % 64);
+                meets++;
+            }
+        }
+        if (meets > gain) gain = meets;
+        search->neighbours[num_neighbours++] = c;
+    }
+    search->kw = kw;
+    search->num_neighbours = num_neighbours;
+    search->gain = gain;
+    search->limit = limit;
+
+    // level 0 is the empty set
+    search->sets[0].last = -1;
+    search->sets[0].parent = -1;
+    memset(search->unions, 0, kw * sizeof(uint64_t));
+    long long max_sets = COVER_SEARCH_MAX_BYTES / (long long) (sizeof(cover_set_t) + kw * sizeof(uint64_t));
+    long long level_begin = 0, level_end = 1;
+    bool fits = true;
+    for (int s = 1; s < search->limit && level_begin < level_end; s++)
+    {
+        long long count = level_end;
+        for (long long e = level_begin; e < level_end && s < search->limit && fits; e++)
+        {
+            for (int i = search->sets[e].last + 1; i < num_neighbours; i++)
+            {
+                if (count >= max_sets)
+                {
+                    fits = false;
+                    break;
+                }
+                if (!cover_search_reserve(search, count + 1, kw)) return -1;
+                const uint64_t *prefix = search->unions + e * kw;
+                const uint64_t *mask = masks + (long long) i * kw;
+                uint64_t *next = search->unions + count * kw;
+                bool adds = false, covers;
+                for (int j = 0; j < kw; j++)
+                {
+                    next[j] = prefix[j] | mask[j];
+                    adds |= next[j] != prefix[j];
+                }
+                if (!adds) continue;
+                if (worth_extending(search, next, s, &covers))
+                { // kept to be extended at the next level
+                    search->sets[count].last = i;
+                    search->sets[count].parent = e;
+                    count++;
+                }
+                else if (covers)
+                {
+                    search->path[0] = i;
+                    write_cover(search, e, 1, subset);
+                    search->limit = s;
+                    break;
+                }
+            }
+        }
+        if (!fits)
+        { // level s does not fit, so the sets of level s - 1 are extended depth first
+            for (long long e = level_begin; e < level_end && s < search->limit; e++)
+            {
+                memcpy(stack, search->unions + e * kw, kw * sizeof(uint64_t));
+                extend_cover_depth_first(search, e, s - 1, 0, search->sets[e].last, subset);
+            }
+            break;
+        }
+        level_begin = level_end;
+        level_end = count;
+    }
+    return search->limit;
+}
+
+int cff_compute_max_d(const cff_t *cff, long long *witness, int witness_capacity, long long *uncovered)
+{
+    if (uncovered != NULL) *uncovered = -1;
+    if (cff == NULL || cff->n < 1 || cff->n > INT32_MAX) return -1;
+    int n = (int) cff->n, w;
+    uint64_t *cols = cff_pack_columns(cff, &w);
+    if (cols == NULL) return -1;
+
+    // an empty column is covered by no columns at all
+    for (int c = 0; c < n; c++)
+    {
+        uint64_t weight = 0;
+        for (int i = 0; i < w; i++) weight |= cols[(long long) c * w + i];
+        if (!weight)
+        {
+            if (uncovered != NULL) *uncovered = c;
+            free(cols);
+            return -1;
+        }
+    }
+
+    cover_search_t search = {0};
+    search.rows = malloc((size_t) w * 64 * sizeof(int));
+    search.neighbours = malloc((size_t) n * sizeof(int));
+    search.path = malloc((size_t) n * sizeof(int));
+    int *subset = malloc((size_t) n * sizeof(int));
+    int max_d = -1;
+    if (search.rows != NULL && search.neighbours != NULL && search.path != NULL && subset != NULL)
+    {
+        int best = n; // no s < n columns cover another one, so the result is n - 1
+        for (int x = 0; x < n && best > 1; x++)
+        {
+            int s = smallest_cover(cols, w, n, x, best, subset, &search);
+            if (s < 0)
+            { // out of memory
+                if (uncovered != NULL) *uncovered = -1;
+                best = 0;
+                break;
+            }
+            if (s < best)
+            {
+                best = s;
+                for (int i = 0; i < s && i < witness_capacity && witness != NULL; i++)
+                {
+                    witness[i] = subset[i];
+                }
+                if (uncovered != NULL) *uncovered = x;
+            }
+        }
+        max_d = best - 1;
+    }
+    free(search.rows);
+    free(search.neighbours);
+    free(search.neighbour_masks);
+    free(search.sets);
+    free(search.unions);
+    free(search.stack);
+    free(search.path);
+    free(search.full);
+    free(subset);
+    free(cols);
+    return max_d;
+}
+
+/*
+    Certification of table CFFs by construction.
+
+    Every node of a recipe is either a direct construction (a leaf), whose
+    strength follows from a theorem once its parameters are valid, or a
+    recursive construction whose theorem only needs its inputs to be CFFs
+    of the right strength and shape. So a table CFF is certified by checking
+    the leaves' parameters and each combinator's preconditions, without ever
+    looking at subsets of columns.
+*/
+
+static bool is_prime(int p)
+{
+    if (p < 2) return false;
+    for (int i = 2; i * i <= p; i++)
+    {
+        if (p % i == 0) return false;
+    }
+    return true;
+}
+
+// true if C(n, k) >= x (choose() returns 0 when C(n, k) overflows)
+static bool choose_at_least(int n, int k, long long x)
+{
+    long long c = choose(n, k);
+    return c == 0 || c >= x;
+}
+
+// the largest d the theorem behind a leaf guarantees, or -1 if the
+// leaf's parameters (or its claimed t) don't satisfy that theorem
+static int certified_leaf_d(const cff_recipe_t *leaf)
+{
+    const short *p = leaf->consParams;
+    switch (leaf->constructionID)
+    {
+    case CFF_CONSTRUCTION_ID_IDENTITY_MATRIX:
+        // every column has a private row
+        if (p[0] != leaf->t || leaf->t < 2) return -1;
+        return leaf->t - 1;
+    case CFF_CONSTRUCTION_ID_SPERNER:
+        // distinct t/2-subsets of a t-set form an antichain
+        if (p[0] != leaf->t || !choose_at_least(leaf->t, leaf->t / 2, leaf->n)) return -1;
+        return 1;
+    case CFF_CONSTRUCTION_ID_STS:
+        // two blocks of a Steiner triple system share at most one point
+        if (p[0] != leaf->t || (p[0] % 6 != 1 && p[0] % 6 != 3)) return -1;
+        return 2;
+    case CFF_CONSTRUCTION_ID_REED_SOLOMON:
+    case CFF_CONSTRUCTION_ID_SHORT_REED_SOLOMON: {
+        // two codewords of a (shortened) Reed-Solomon code of length m and dimension k
+        // agree in at most k-1 positions, and each column has weight m
+        int prime = p[0], e = p[1], k = p[2], m = p[3];
+        int s = leaf->constructionID == CFF_CONSTRUCTION_ID_REED_SOLOMON ? 0 : p[4];
+        if (!is_prime(prime) || e < 1 || k < 2 || s < 0 || s >= k || s >= m) return -1;
+        long long q = 1;
+        for (int i = 0; i < e; i++)
+        {
+            q *= prime;
+            if (q > 1 << 20) return -1;
+        }
+        if (m > q + 1 || leaf->t != (m - s) * q) return -1;
+        if (k - s - 1 == 0) return (int) (q - 1); // the columns have disjoint supports
+        return (m - s - 1) / (k - s - 1);
+    }
+    case CFF_CONSTRUCTION_ID_PORAT_ROTHSCHILD: {
+        // the derandomized code has relative distance at least (r-1)/r once
+        // m >= k / (1 - Hq), for an alphabet 2r <= q < 4r
+        int prime = p[0], a = p[1], k = p[2], m = p[3], r = p[4];
+        if (!is_prime(prime) || a < 1 || k < 1 || r < 2) return -1;
+        long long q = 1;
+        for (int i = 0; i < a; i++)
+        {
+            q *= prime;
+            if (q > 1 << 20) return -1;
+        }
+        if (q < 2 * r || q >= 4 * r || leaf->t != m * q) return -1;
+        double Hq = porat_entropy_function((double) q, (double) r);
+        if (Hq >= 1.0 || m < (int) ceil(((double) k) / (1.0 - Hq))) return -1;
+        int D = (int) floor(((double) (r - 1)) / ((double) r) * m);
+        if (m - D <= 0) return -1;
+        return (m - 1) / (m - D);
+    }
+    case CFF_CONSTRUCTION_ID_FIXED_CFF: {
+        // hardcoded matrices have no theorem behind them, but are small enough to check directly
+        cff_t *fixed = cff_fixed(2, leaf->t);
+        if (fixed == NULL) return -1;
+        bool valid = cff_get_n(fixed) == leaf->n && cff_verify(fixed);
+        cff_free(fixed);
+        return valid ? 2 : -1;
+    }
+    default:
+        return -1;
+    }
+}
+
+// true if the recipe node produces a d-CFF(t, n) with d = node->d
+static bool recipe_is_certified(const cff_recipe_t *node)
+{
+    if (node->num_children == 0)
+    {
+        return certified_leaf_d(node) >= node->d;
+    }
+
+    // the inputs must be certified themselves, and strong enough
+    for (int i = 0; i < node->num_children; i++)
+    {
+        if (!recipe_is_certified(node->children[i])) return false;
+    }
+    cff_recipe_t *const *c = node->children;
+    switch (node->constructionID)
+    {
+    case CFF_CONSTRUCTION_ID_EXT_BY_ONE:
+        return node->num_children == 1 && c[0]->d >= node->d
+            && node->t == c[0]->t + 1;
+    case CFF_CONSTRUCTION_ID_ADDITIVE:
+        return node->num_children == 2 && c[0]->d >= node->d && c[1]->d >= node->d
+            && node->t == c[0]->t + c[1]->t;
+    case CFF_CONSTRUCTION_ID_KRONECKER:
+        return node->num_children == 2 && c[0]->d >= node->d && c[1]->d >= node->d
+            && node->t == c[0]->t * c[1]->t;
+    case CFF_CONSTRUCTION_ID_DOUBLING: {
+        // the middle rows need n distinct ceil(s/2)-subsets of an s-set
+        int s = node->consParams[1];
+        return node->num_children == 1 && node->d <= 2 && c[0]->d >= 2
+            && s > 0 && choose_at_least(s, (s + 1) / 2, c[0]->n)
+            && node->t == c[0]->t + s + 2 - (s % 2);
+    }
+    case CFF_CONSTRUCTION_ID_OPTIMIZED_KRONECKER:
+        // outer is a (d-1)-CFF with at least as many columns as bottom
+        return node->num_children == 3 && c[0]->d >= node->d - 1
+            && c[1]->d >= node->d && c[2]->d >= node->d
+            && c[0]->n >= c[2]->n
+            && node->t == c[0]->t * c[1]->t + c[2]->t;
+    default:
+        return false;
+    }
+}
+
+bool cff_verify_by_construction(const cff_t *cff)
+{
+    if (cff == NULL) return false;
+    if (cff->recipe == NULL)
+    { // nothing to certify from, check it the long way
+        return cff_verify(cff);
+    }
+    const cff_recipe_t *recipe = cff->recipe;
+    // the cells must still be the ones that were constructed
+    if (cff_matrix_checksum(cff) != cff->matrix_checksum) return false;
+    if (cff->t != recipe->t || cff->n > recipe->n || cff->d > recipe->d) return false;
+    if (cff->d + 1 > cff->n) return false;
+    return recipe_is_certified(recipe);
+}
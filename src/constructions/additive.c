@@ -34,6 +34,9 @@ cff_t* cff_additive(const cff_t *left, const cff_t *right)
         }
     }
 
+    const short params[5] = {(short) right->t, (short) left->t, 0, 0, 0};
+    const cff_t *inputs[2] = {left, right};
+    cff_attach_product_recipe(result, CFF_CONSTRUCTION_ID_ADDITIVE, params, inputs, 2);
     return result;
 }
 
@@ -26,8 +26,40 @@ void cff_table_add_sts_cffs(cff_table_ctx_t *ctx, int t_max);
 void cff_table_add_porat_rothschild_cffs(cff_table_ctx_t *ctx, int cff_d, int t_max, bool *prime_array);
 void cff_table_add_reed_solomon_cffs(cff_table_ctx_t *ctx, int cff_d, int t_max, bool *prime_array);
 void cff_table_add_fixed_cffs(cff_table_ctx_t *ctx);
-void cff_table_add_ext_by_one_cffs(cff_table_ctx_t *ctx, int cff_d);
-void cff_table_add_doubling_cffs(cff_table_ctx_t *ctx); //only for d=2
-void cff_table_add_pair_constructed_cffs(cff_table_ctx_t *ctx, int cff_d);
+
+// the recursive constructions build row t of a table only from rows below t, so the tables are
+// filled in one pass of increasing t: these offer row t every candidate from the (final) rows below
+void cff_table_pull_ext_by_one_cff(cff_table_ctx_t *ctx, int cff_d, int t);
+void cff_table_pull_doubling_cff(cff_table_ctx_t *ctx, int t); //only for d=2
+// the pair constructions pull through an index of the final rows of the table, kept by the pulls;
+// d_minus_one_rows: the rows of the (d-1) table that are final, looked up for optimized Kronecker
+typedef struct pair_pull_index pair_pull_index_t;
+pair_pull_index_t* cff_table_pair_pull_create(cff_table_ctx_t *ctx, int cff_d, const int *smallest_factor);
+void cff_table_pair_pull_free(pair_pull_index_t *index);
+void cff_table_pull_pair_constructed_cffs(pair_pull_index_t *index, int t, int d_minus_one_rows);
+
+// the n of cff_fixed(d, t) without constructing it, or -1 if there is no such CFF
+long long cff_fixed_get_n(int d, int t);
+
+// the q-ary entropy bound used to pick m in the Porat and Rothschild construction
+double porat_entropy_function(double q, double r);
+
+// row permutations of cff_reed_solomon(p, e, k, m) / cff_sts(v) that map its columns onto
+// its columns (translating and scaling the polynomials / shifting the points). *perms is
+// allocated with count * t entries; returns count, or -1 if memory could not be allocated
+int reed_solomon_row_automorphisms(int p, int e, int k, int m, int **perms);
+int sts_row_automorphisms(int v, int **perms);
+
+// GF(p^e) by the logarithms of a primitive element, in O(p^e) memory, with the elements numbered
+// as in populate_finite_field(); NULL if memory could not be allocated
+typedef struct finite_field finite_field_t;
+finite_field_t* finite_field_create(int p, int e);
+void finite_field_free(finite_field_t *field);
+
+// decodes the outcomes of the tests of cff_short_reed_solomon(p, exp, k, m, s) (s = 0 for
+// cff_reed_solomon) by list recovery over the field GF(p^exp), without building the CFF
+long long reed_solomon_list_decode(const finite_field_t *field, int k, int m, int s,
+                                   const unsigned char *outcomes,
+                                   long long *positives, long long max_positives);
 
 #endif
\ No newline at end of file
@@ -8,20 +8,22 @@
 #include "../cff_internals.h"
 
 
-// the function to fill in a table with the doubling construction parameters
-void cff_table_add_doubling_cffs(cff_table_ctx_t *ctx)
+// the function to fill in row t of the d=2 table with the doubling construction parameters
+void cff_table_pull_doubling_cff(cff_table_ctx_t *ctx, int t)
 {
     long long n;
     int s;
     cff_table_t *table_1 = ctx->tables_array[0];
     cff_table_t *table_2 = ctx->tables_array[1];
-    for (int t = 2; t < table_2->numCFFs; t++)
+    // row u doubles to row u + s + 2 - (s % 2), where s is a row of the d=1 table
+    int first = t - table_1->numCFFs - 1 > 2 ? t - table_1->numCFFs - 1 : 2;
+    for (int u = first; u < t; u++)
     {
-        n = table_2->array[t].n;
+        n = table_2->array[u].n;
         s = binary_search_table(table_1, n);
-        if (s != -1)
+        if (s != -1 && u + s + 2 - (s % 2) == t)
         {
-            update_table(table_2, t + s + 2 - (s % 2), 2 * n, CFF_CONSTRUCTION_ID_DOUBLING, t, s, 0, 0, 0);
+            update_table(table_2, t, 2 * n, CFF_CONSTRUCTION_ID_DOUBLING, u, s, 0, 0, 0);
         }
     }
 }
@@ -115,6 +117,8 @@ cff_t* cff_doubling(const cff_t *cff, int s)
             cff_set_matrix_value(resultCFF, cff->t + s+1, i, 1);
         }
     }
+    const short params[5] = {(short) cff->t, (short) s, 0, 0, 0};
+    cff_attach_product_recipe(resultCFF, CFF_CONSTRUCTION_ID_DOUBLING, params, &cff, 1);
     return resultCFF;
 }
 
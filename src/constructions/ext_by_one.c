@@ -13,14 +13,16 @@ cff_t* cff_extend_by_one(const cff_t* cff)
     if (one_by_one_cff == NULL) return NULL;
     cff_t *result_cff = cff_additive(cff, one_by_one_cff);
     cff_free(one_by_one_cff);
+    const short params[5] = {(short) cff->t, 0, 0, 0, 0};
+    cff_attach_product_recipe(result_cff, CFF_CONSTRUCTION_ID_EXT_BY_ONE, params, &cff, 1);
     return result_cff;
 }
 
-void cff_table_add_ext_by_one_cffs(cff_table_ctx_t *ctx, int cff_d)
+void cff_table_pull_ext_by_one_cff(cff_table_ctx_t *ctx, int cff_d, int t)
 {
     cff_table_t *table = ctx->tables_array[cff_d-1];
-    for (int t = cff_d+1; t < table->numCFFs; t++)
+    if (t - 1 > cff_d)
     {
-        update_table(table, t + 1, table->array[t].n + 1, CFF_CONSTRUCTION_ID_EXT_BY_ONE, t, 0, 0, 0, 0);
+        update_table(table, t, table->array[t - 1].n + 1, CFF_CONSTRUCTION_ID_EXT_BY_ONE, t - 1, 0, 0, 0, 0);
     }
-}
\ No newline at end of file
+}
@@ -183,6 +183,81 @@ int populate_finite_field(int p, int k, int *addition_field, int *multiplication
     fq_ctx_clear(ctx);
     return 0;
 }
+int populate_finite_field_logs(int p, int k, int *antilog, int *log) {
+    if (k > MAX_K || k <= 0 || p <= 1) {
+        return -1; // invalid parameters
+    }
+
+    int field_size = compute_field_size(p, k);
+    if (field_size <= 0) {
+        return -1; // field size computation failed
+    }
+
+    // initialize context, the same as populate_finite_field so the elements are numbered the same
+    fq_ctx_t ctx;
+    fmpz_t p_fmpz;
+    fmpz_init_set_ui(p_fmpz, p);
+    fq_ctx_init(ctx, p_fmpz, k, "c");
+
+    int *temp_coeffs = malloc(k * sizeof(int));
+    if (!temp_coeffs) {
+        fmpz_clear(p_fmpz);
+        fq_ctx_clear(ctx);
+        return -1;
+    }
+
+    field_element_t candidate, power;
+    fmpz_poly_init(candidate.poly);
+    fmpz_poly_fit_length(candidate.poly, k);
+    fq_init(candidate.ff, ctx);
+    fmpz_poly_init(power.poly);
+    fq_init(power.ff, ctx);
+
+    // try the elements in turn until one has order field_size - 1, writing its powers as we go
+    int primitive = -1;
+    for (int c = 1; c < field_size && primitive < 0; c++)
+    {
+        int temp = c;
+        for (int j = 0; j < k; j++) {
+            fmpz_poly_set_coeff_si(candidate.poly, j, temp % p);
+            temp /= p;
+        }
+        fq_set_fmpz_poly(candidate.ff, candidate.poly, ctx);
+
+        fq_one(power.ff, ctx);
+        int value = 1;
+        int order = 0;
+        do
+        {
+            antilog[order++] = value;
+            fq_mul(power.ff, power.ff, candidate.ff, ctx);
+            fq_get_fmpz_poly(power.poly, power.ff, ctx);
+            for (int l = 0; l < k; l++) {
+                temp_coeffs[l] = fmpz_poly_get_coeff_si(power.poly, l);
+            }
+            value = convertPolynomialToInteger_opt(p, k, temp_coeffs);
+        } while (value != 1 && order < field_size - 1);
+        if (value == 1 && order == field_size - 1)
+        {
+            primitive = c;
+        }
+    }
+    log[0] = -1;
+    for (int i = 0; i < field_size - 1; i++)
+    {
+        log[antilog[i]] = i;
+    }
+
+    // free memory
+    fmpz_clear(p_fmpz);
+    fq_clear(candidate.ff, ctx);
+    fmpz_poly_clear(candidate.poly);
+    fq_clear(power.ff, ctx);
+    fmpz_poly_clear(power.poly);
+    free(temp_coeffs);
+    fq_ctx_clear(ctx);
+    return primitive > 0 ? 0 : -1;
+}
 // horner's method
 // https://en.wikipedia.org/wiki/Horner%27s_method#Polynomial_evaluation_and_long_division
 int horner_polynomial_eval_over_fq(int polyLength, int *polynomialCoefficients, int x, int q, int *addition_field, int *multiplication_field)
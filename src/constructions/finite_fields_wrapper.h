@@ -5,6 +5,9 @@
 
 int populate_finite_field(int p, int k, int *addition_field, int *multiplication_field);
 int compute_field_size(int p, int k);
+// antilog[i] = g^i for 0 <= i < p^k - 1 and log[a] = i for a = g^i (log[0] = -1), for a primitive
+// element g, with the elements numbered as in populate_finite_field(); O(p^k) time and memory
+int populate_finite_field_logs(int p, int k, int *antilog, int *log);
 int horner_polynomial_eval_over_fq(
     int polyLength,
     int *polynomialCoefficients,
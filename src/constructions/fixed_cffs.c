@@ -394,21 +394,30 @@ cff_t* cff_fixed(int d, int t)
     }
 }
 
+// the (t, n) of each hardcoded 2-CFF above, for t = 10 ... 23
+static const long long fixed_2_cff_sizes[][2] = {
+    {10, 13}, {11, 17}, {12, 20}, {13, 26}, {14, 28}, {15, 42}, {16, 48},
+    {17, 68}, {18, 69}, {19, 76}, {20, 90}, {21, 120}, {22, 176}, {23, 253}
+};
+
+#define NUM_FIXED_2_CFFS ((int) (sizeof(fixed_2_cff_sizes) / sizeof(fixed_2_cff_sizes[0])))
+
+// the n of cff_fixed(d, t) without constructing it, or -1 if there is no such CFF
+long long cff_fixed_get_n(int d, int t)
+{
+    if (d != 2) return -1;
+    for (int i = 0; i < NUM_FIXED_2_CFFS; i++)
+    {
+        if (fixed_2_cff_sizes[i][0] == t) return fixed_2_cff_sizes[i][1];
+    }
+    return -1;
+}
+
 void cff_table_add_fixed_cffs(cff_table_ctx_t *ctx)
 {
     cff_table_t *table = ctx->tables_array[1];
-    update_table(table, 10, 13, CFF_CONSTRUCTION_ID_FIXED_CFF, 0, 0, 0, 0, 0);
-    update_table(table, 11, 17, CFF_CONSTRUCTION_ID_FIXED_CFF, 0, 0, 0, 0, 0);
-    update_table(table, 12, 20, CFF_CONSTRUCTION_ID_FIXED_CFF, 0, 0, 0, 0, 0);
-    update_table(table, 13, 26, CFF_CONSTRUCTION_ID_FIXED_CFF, 0, 0, 0, 0, 0);
-    update_table(table, 14, 28, CFF_CONSTRUCTION_ID_FIXED_CFF, 0, 0, 0, 0, 0);
-    update_table(table, 15, 42, CFF_CONSTRUCTION_ID_FIXED_CFF, 0, 0, 0, 0, 0);
-    update_table(table, 16, 48, CFF_CONSTRUCTION_ID_FIXED_CFF, 0, 0, 0, 0, 0);
-    update_table(table, 17, 68, CFF_CONSTRUCTION_ID_FIXED_CFF, 0, 0, 0, 0, 0);
-    update_table(table, 18, 69, CFF_CONSTRUCTION_ID_FIXED_CFF, 0, 0, 0, 0, 0);
-    update_table(table, 19, 76, CFF_CONSTRUCTION_ID_FIXED_CFF, 0, 0, 0, 0, 0);
-    update_table(table, 20, 90, CFF_CONSTRUCTION_ID_FIXED_CFF, 0, 0, 0, 0, 0);
-    update_table(table, 21, 120, CFF_CONSTRUCTION_ID_FIXED_CFF, 0, 0, 0, 0, 0);
-    update_table(table, 22, 176, CFF_CONSTRUCTION_ID_FIXED_CFF, 0, 0, 0, 0, 0);
-    update_table(table, 23, 253, CFF_CONSTRUCTION_ID_FIXED_CFF, 0, 0, 0, 0, 0);
+    for (int i = 0; i < NUM_FIXED_2_CFFS; i++)
+    {
+        update_table(table, (int) fixed_2_cff_sizes[i][0], fixed_2_cff_sizes[i][1], CFF_CONSTRUCTION_ID_FIXED_CFF, 0, 0, 0, 0, 0);
+    }
 }
@@ -48,6 +48,9 @@ cff_t* cff_kronecker(const cff_t *left, const cff_t *right)
         }
     }
 
+    const short params[5] = {(short) left->t, (short) right->t, 0, 0, 0};
+    const cff_t *inputs[2] = {left, right};
+    cff_attach_product_recipe(product_cff, CFF_CONSTRUCTION_ID_KRONECKER, params, inputs, 2);
     return product_cff;
 }
 
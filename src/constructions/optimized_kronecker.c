@@ -3,6 +3,8 @@
 #include "../cff_internals.h"
 
 #include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 cff_t* cff_optimized_kronecker
 (
@@ -79,51 +81,202 @@ cff_t* cff_optimized_kronecker
             }
         }
     }
+    const short params[5] = {(short) kronecker_inner->t, (short) bottom_cff->t, (short) kronecker_outer->t, 0, 0};
+    const cff_t *inputs[3] = {kronecker_outer, kronecker_inner, bottom_cff};
+    cff_attach_product_recipe(product_cff, CFF_CONSTRUCTION_ID_OPTIMIZED_KRONECKER, params, inputs, 3);
     return product_cff;
 }
 
-void cff_table_add_pair_constructed_cffs(cff_table_ctx_t *ctx, int cff_d)
+/*
+    Pulling the pair constructions of row t of a table, from the final rows
+    below it. To keep this well under O(t) per row, an index of the rows is
+    kept up to date as the rows become final:
+
+    - Additive: if n[t1] = n[t1-1] + 1, the pair (t1-1, t2+1) comes before
+      (t1, t2) and has at least its n, because n[t2+1] >= n[t2] + 1 (every
+      row is at least the extension by one of the row before it). So t1 only
+      needs to run over the rows that jump by more than one over the row
+      before them, and over t1 = d.
+    - Kronecker: t1 runs over the divisors of t, found from a smallest prime
+      factor sieve instead of by trial division.
+    - Optimized Kronecker: s, the smallest t of a (d-1)-CFF on the n of row
+      t2, is found once per row by walking the (d-1) table alongside (both
+      tables increase in n), and stored as runs of rows with equal s. Within
+      a run, t = s * t1 + t2 only for t2 = t (mod s), so those are stepped
+      through directly.
+
+    Each additive pair left out has a pair before it with at least its n, and
+    the Kronecker and optimized Kronecker pairs are the same ones as trying
+    every pair, offered in the same order (increasing t1, and increasing t2).
+    update_table() keeps the first of equal candidates, so every row records
+    the same construction as trying every pair in this order would.
+    tests/reference holds tables to check this against.
+*/
+
+#define MAX_DIVISORS 1600 // no int has more
+
+struct pair_pull_index
 {
-    int t, s;
-    long long n;
-    cff_table_t *table = ctx->tables_array[cff_d-1];
-    cff_table_t *d_minus_one_table = ctx->tables_array[cff_d-2];
-    for (int t1 = cff_d; t1 < table->numCFFs - 1; t1++)
+    cff_table_t *table;
+    cff_table_t *d_minus_one_table;
+    int d;
+    const int *smallest_factor;
+    int *jump_rows; // t1 = d and the rows with n[t1] > n[t1-1] + 1, in increasing order
+    int num_jump_rows;
+    int rows_seen; // the rows below this have been checked for jump_rows
+    int *run_first; // the first row t2 of each run of rows with the same s
+    int *run_s;
+    int num_runs;
+    int s_rows; // the rows below this have their s in a run
+    bool s_done; // the (d-1) table has no CFF on the n of row s_rows, nor of any row above it
+    int lower_row; // the row of the (d-1) table the walk is at
+    int divisors[MAX_DIVISORS];
+};
+
+pair_pull_index_t* cff_table_pair_pull_create(cff_table_ctx_t *ctx, int cff_d, const int *smallest_factor)
+{
+    pair_pull_index_t *index = malloc(sizeof(pair_pull_index_t));
+    if (index == NULL)
     {
-        for (int t2 = t1; t2 < table->numCFFs; t2++)
-        {
-            // addative construction
-            t = t1 + t2;
-            if (t > table->numCFFs)
-            {
-                break;
-            }
-            n = table->array[t1].n + table->array[t2].n;
-            update_table(table, t, n, CFF_CONSTRUCTION_ID_ADDITIVE, t1, t2, 0, 0, 0);
+        printf("malloc fail'd index in cff_table_pair_pull_create\n");
+        exit(1);
+    }
+    index->table = ctx->tables_array[cff_d-1];
+    index->d_minus_one_table = ctx->tables_array[cff_d-2];
+    index->d = cff_d;
+    index->smallest_factor = smallest_factor;
+    index->jump_rows = malloc(sizeof(int) * (index->table->numCFFs + 1));
+    index->run_first = malloc(sizeof(int) * (index->table->numCFFs + 1));
+    index->run_s = malloc(sizeof(int) * (index->table->numCFFs + 1));
+    if (index->jump_rows == NULL || index->run_first == NULL || index->run_s == NULL)
+    {
+        printf("malloc fail'd arrays in cff_table_pair_pull_create\n");
+        exit(1);
+    }
+    index->num_jump_rows = 0;
+    index->rows_seen = cff_d;
+    index->num_runs = 0;
+    index->s_rows = cff_d;
+    index->s_done = false;
+    index->lower_row = 0;
+    return index;
+}
 
-            // kronecker product
-            t = t1 * t2;
-            n = table->array[t1].n * table->array[t2].n;
-            update_table(table, t, n, CFF_CONSTRUCTION_ID_KRONECKER, t1, t2, 0, 0, 0);
+void cff_table_pair_pull_free(pair_pull_index_t *index)
+{
+    if (index == NULL) return;
+    free(index->jump_rows);
+    free(index->run_first);
+    free(index->run_s);
+    free(index);
+}
 
-            // try optimized kronecker in both combinations (t1,t2) & (t2,t1)
-            s = binary_search_table(d_minus_one_table, table->array[t2].n);
-            if (s != -1)
-            {
-                t = (s * t1) + t2;
-                n = table->array[t1].n * table->array[t2].n;
-                update_table(table, t, n, CFF_CONSTRUCTION_ID_OPTIMIZED_KRONECKER, t1, t2, s, 0, 0);
-            }
-            // try the other way for opt kronecker
-            s = binary_search_table(d_minus_one_table, table->array[t1].n);
-            if (s != -1)
+// the divisors of t in increasing order, returns how many
+static int sorted_divisors(const int *smallest_factor, int t, int *divisors)
+{
+    int count = 1;
+    divisors[0] = 1;
+    while (t > 1)
+    {
+        int p = smallest_factor[t], power = 1, old_count = count;
+        while (t % p == 0)
+        {
+            t /= p;
+            power *= p;
+            for (int i = 0; i < old_count; i++)
             {
-                t = (s * t2) + t1;
-                n = table->array[t1].n * table->array[t2].n;
-                update_table(table, t, n, CFF_CONSTRUCTION_ID_OPTIMIZED_KRONECKER, t2, t1, s, 0, 0);
+                divisors[count++] = divisors[i] * power;
             }
         }
     }
+    for (int i = 1; i < count; i++)
+    {
+        int x = divisors[i], j = i;
+        while (j > 0 && divisors[j-1] > x)
+        {
+            divisors[j] = divisors[j-1];
+            j--;
+        }
+        divisors[j] = x;
+    }
+    return count;
 }
 
+// brings the index up to the rows below t, with d_minus_one_rows final rows in the (d-1) table
+static void update_index(pair_pull_index_t *index, int t, int d_minus_one_rows)
+{
+    const cff_table_row_t *rows = index->table->array;
+    for (; index->rows_seen < t; index->rows_seen++)
+    {
+        int r = index->rows_seen;
+        if (r == index->d || rows[r].n > rows[r-1].n + 1)
+        {
+            index->jump_rows[index->num_jump_rows++] = r;
+        }
+    }
+    const cff_table_row_t *lower = index->d_minus_one_table->array;
+    for (; !index->s_done && index->s_rows + index->d <= t; index->s_rows++)
+    {
+        long long n = rows[index->s_rows].n;
+        while (index->lower_row < d_minus_one_rows && lower[index->lower_row].n < n)
+        {
+            index->lower_row++;
+        }
+        if (index->lower_row == d_minus_one_rows)
+        {
+            index->s_done = true;
+            break;
+        }
+        if (index->num_runs == 0 || index->run_s[index->num_runs - 1] != index->lower_row)
+        {
+            index->run_first[index->num_runs] = index->s_rows;
+            index->run_s[index->num_runs] = index->lower_row;
+            index->num_runs++;
+        }
+    }
+}
+
+void cff_table_pull_pair_constructed_cffs(pair_pull_index_t *index, int t, int d_minus_one_rows)
+{
+    int s, cff_d = index->d;
+    long long n;
+    cff_table_t *table = index->table;
+    update_index(index, t, d_minus_one_rows);
 
+    // addative construction, t = t1 + t2
+    for (int i = 0; i < index->num_jump_rows && 2 * index->jump_rows[i] <= t; i++)
+    {
+        int t1 = index->jump_rows[i];
+        n = table->array[t1].n + table->array[t - t1].n;
+        update_table(table, t, n, CFF_CONSTRUCTION_ID_ADDITIVE, t1, t - t1, 0, 0, 0);
+    }
+
+    // kronecker product, t = t1 * t2
+    int num_divisors = sorted_divisors(index->smallest_factor, t, index->divisors);
+    for (int i = 0; i < num_divisors && (long long) index->divisors[i] * index->divisors[i] <= t; i++)
+    {
+        int t1 = index->divisors[i];
+        if (t1 >= cff_d)
+        {
+            n = table->array[t1].n * table->array[t / t1].n;
+            update_table(table, t, n, CFF_CONSTRUCTION_ID_KRONECKER, t1, t / t1, 0, 0, 0);
+        }
+    }
+
+    // optimized kronecker, t = s * t1 + t2 where s is the smallest t with
+    // a (d-1)-CFF on the n of t2 columns, in both orders of t1 and t2
+    for (int k = 0; k < index->num_runs; k++)
+    {
+        s = index->run_s[k];
+        int first = index->run_first[k];
+        int last = k + 1 < index->num_runs ? index->run_first[k+1] - 1 : index->s_rows - 1;
+        if (first > t - cff_d * s) break; // t1 < d here and in the runs after, which have larger s
+        if (last > t - cff_d * s) last = t - cff_d * s;
+        for (int t2 = first + (t - first) % s; t2 <= last; t2 += s)
+        {
+            int t1 = (t - t2) / s;
+            n = table->array[t1].n * table->array[t2].n;
+            update_table(table, t, n, CFF_CONSTRUCTION_ID_OPTIMIZED_KRONECKER, t1, t2, s, 0, 0);
+        }
+    }
+}
@@ -6,6 +6,7 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 
 #include "../cff_internals.h"
 #include "finite_fields_wrapper.h"
@@ -18,7 +19,8 @@ void cff_table_add_reed_solomon_cffs(cff_table_ctx_t *ctx, int cff_d, int t_max,
     long long q;
     short m, short_m, short_k, e;
     int cff_t;
-    for (short p = 2; (unsigned) p <= ceil(sqrt(t_max)); p++) //loop over q
+    // the smallest code on q = p is the shortened one with k = 2 and s = 1, which has t = d * p
+    for (int p = 2; p <= t_max && (long long) cff_d * p < table->numCFFs; p++) //loop over q
     {
         if (prime_array[p])
         {
@@ -33,11 +35,19 @@ void cff_table_add_reed_solomon_cffs(cff_table_ctx_t *ctx, int cff_d, int t_max,
                     {
                         break;
                     }
+                    // the codes for k have t >= (m - s) * q for the largest s, which grows with k
+                    int largest_s = q - 1 < k - 1 ? q - 1 : k - 1;
+                    if ((m - largest_s) * q >= table->numCFFs)
+                    {
+                        break;
+                    }
                     cff_t = m * q;
                     if (cff_t < 0) break; //this means overflow happened in above line
                     cff_n = pow(q, k);
                     update_table(table, cff_t, cff_n, CFF_CONSTRUCTION_ID_REED_SOLOMON, p, e, k, m, 0);
-                    for (int s = 1; s + 1 <= q && s < m && s < k; s++)
+                    // the shortened codes have t = (m - s) * q, which only fits in the table from this s on
+                    int first_s = m - (table->numCFFs - 1) / q > 1 ? m - (table->numCFFs - 1) / q : 1;
+                    for (int s = first_s; s + 1 <= q && s < m && s < k; s++)
                     {
                         short_m = m - s;
                         short_k = k - s;
@@ -99,4 +109,440 @@ cff_t* cff_reed_solomon(int p, int exp, int t, int m)
     free(addition_field);
     free(multiplication_field);
    return cff;
-}
\ No newline at end of file
+}
+
+int reed_solomon_row_automorphisms(int p, int e, int k, int m, int **perms)
+{
+    *perms = NULL;
+    int q = ipow(p, e);
+    int t = m * q;
+    int *addition_field = malloc(q * q * sizeof(int));
+    int *multiplication_field = malloc(q * q * sizeof(int));
+    if (addition_field == NULL || multiplication_field == NULL
+        || populate_finite_field(p, e, addition_field, multiplication_field) != 0)
+    {
+        free(addition_field);
+        free(multiplication_field);
+        return -1;
+    }
+    // adding a * x^j (j < k-1, so the leading coefficient is untouched) to every polynomial,
+    // for a in {1, p, ..., p^(e-1)}, and multiplying every polynomial by c != 0, 1
+    int max_count = (k - 1) * e + (q - 2);
+    *perms = malloc((size_t) max_count * t * sizeof(int));
+    if (*perms == NULL)
+    {
+        free(addition_field);
+        free(multiplication_field);
+        return -1;
+    }
+    int count = 0;
+    for (int j = 0; j < k - 1; j++)
+    {
+        for (int a = 1; a < q; a *= p)
+        {
+            int *perm = *perms + (long long) count * t;
+            for (int v = 0; v < q; v++)
+            {
+                perm[v] = v; // the leading coefficient row group is fixed
+            }
+            for (int g = 1; g < m; g++)
+            {
+                int x = g - 1; // the point row group g is evaluated at
+                int term = a;
+                for (int i = 0; i < j; i++)
+                {
+                    term = multiplication_field[term * q + x];
+                }
+                for (int v = 0; v < q; v++)
+                {
+                    perm[g * q + v] = g * q + addition_field[v * q + term];
+                }
+            }
+            count++;
+        }
+    }
+    for (int c = 2; c < q; c++)
+    {
+        int *perm = *perms + (long long) count * t;
+        for (int g = 0; g < m; g++)
+        {
+            for (int v = 0; v < q; v++)
+            {
+                perm[g * q + v] = g * q + multiplication_field[v * q + c];
+            }
+        }
+        count++;
+    }
+    free(addition_field);
+    free(multiplication_field);
+    return count;
+}
+
+/*
+    List decoding.
+
+    A codeword is a positive item exactly when each of its symbols is in a
+    positive row of its group, so decoding is finding every codeword whose
+    symbols come from the sets S_g of positive rows of the groups. A
+    codeword of the code shortened s times is p(x) = Z(x) * h(x), where
+    Z(x) = x(x-1)...(x-(s-2)) has the s-1 points that were shortened away as
+    its roots and h has degree < K = k - s (for s = 0, Z = 1 and the leading
+    coefficient group is the value "at infinity" of h). Any K of the groups
+    determine h, so the decoder picks the K groups with the fewest positive
+    rows, interpolates h through every choice of their symbols and checks
+    the other groups. That is prod |S_g| <= d^K interpolations over the K
+    chosen groups, independent of n = q^K.
+
+    The field arithmetic goes through the logarithms of a primitive element
+    g: a * b = g^(log a + log b), and a + b = a * (1 + b/a) with the Zech
+    logarithm 1 + g^i = g^zech[i]. The tables take O(q) time and memory to
+    build, no more than reading the m * q outcomes, where q x q addition and
+    multiplication tables would cost Theta(n) for k = 2.
+*/
+
+struct finite_field
+{
+    int p;
+    int q;
+    int *antilog; // g^i for 0 <= i < 2(q-1), so a sum of two logarithms needs no reduction
+    int *log;     // log[0] = -1
+    int *zech;    // 1 + g^i = g^zech[i], or -1 when 1 + g^i = 0
+};
+
+finite_field_t* finite_field_create(int p, int e)
+{
+    int q = compute_field_size(p, e);
+    if (q < 2) return NULL;
+    finite_field_t *field = malloc(sizeof(finite_field_t));
+    if (field == NULL) return NULL;
+    field->p = p;
+    field->q = q;
+    field->antilog = malloc((size_t) 2 * (q - 1) * sizeof(int));
+    field->log = malloc((size_t) q * sizeof(int));
+    field->zech = malloc((size_t) (q - 1) * sizeof(int));
+    if (field->antilog == NULL || field->log == NULL || field->zech == NULL
+        || populate_finite_field_logs(p, e, field->antilog, field->log) != 0)
+    {
+        finite_field_free(field);
+        return NULL;
+    }
+    for (int i = 0; i < q - 1; i++)
+    {
+        field->antilog[q - 1 + i] = field->antilog[i];
+        // adding 1 only changes the constant coefficient, the lowest base p digit
+        int x = field->antilog[i];
+        field->zech[i] = field->log[x - x % p + (x % p + 1) % p];
+    }
+    return field;
+}
+
+void finite_field_free(finite_field_t *field)
+{
+    if (field == NULL) return;
+    free(field->antilog);
+    free(field->log);
+    free(field->zech);
+    free(field);
+}
+
+static inline int field_mul(const finite_field_t *f, int a, int b)
+{
+    if (a == 0 || b == 0) return 0;
+    return f->antilog[f->log[a] + f->log[b]];
+}
+
+static inline int field_add(const finite_field_t *f, int a, int b)
+{
+    if (a == 0) return b;
+    if (b == 0) return a;
+    int i = f->log[b] - f->log[a];
+    if (i < 0) i += f->q - 1;
+    return f->zech[i] < 0 ? 0 : f->antilog[f->log[a] + f->zech[i]];
+}
+
+static inline int field_neg(const finite_field_t *f, int a)
+{
+    // -1 = g^((q-1)/2) in odd characteristic
+    if (a == 0 || f->p == 2) return a;
+    return f->antilog[f->log[a] + (f->q - 1) / 2];
+}
+
+// a must not be 0
+static inline int field_inv(const finite_field_t *f, int a)
+{
+    return f->antilog[f->q - 1 - f->log[a]];
+}
+
+static int field_pow(const finite_field_t *f, int x, int e)
+{
+    if (e == 0) return 1;
+    if (x == 0) return 0;
+    return f->antilog[(long long) f->log[x] * e % (f->q - 1)];
+}
+
+// polynomials are stored lowest degree first in this section
+
+// coefficients of the Lagrange basis polynomials through the points xs
+// (basis[j * L + i] is the coefficient of x^i in L_j)
+static void lagrange_basis(const finite_field_t *f, const int *xs, int L, int *basis)
+{
+    for (int j = 0; j < L; j++)
+    {
+        int *poly = basis + j * L;
+        poly[0] = 1;
+        for (int i = 1; i < L; i++) poly[i] = 0;
+        int degree = 0, denominator = 1;
+        for (int i = 0; i < L; i++)
+        {
+            if (i == j) continue;
+            // poly *= (x - xs[i])
+            for (int e = degree + 1; e > 0; e--)
+            {
+                poly[e] = field_add(f, poly[e-1], field_mul(f, poly[e], field_neg(f, xs[i])));
+            }
+            poly[0] = field_mul(f, poly[0], field_neg(f, xs[i]));
+            degree++;
+            denominator = field_mul(f, denominator, field_add(f, xs[j], field_neg(f, xs[i])));
+        }
+        for (int e = 0; e < L; e++) poly[e] = field_mul(f, poly[e], field_inv(f, denominator));
+    }
+}
+
+// pivot coordinates of the code shortened s times: its codewords' lex order (over the k
+// coefficients, highest degree first) is the lex order of their coefficients at the pivots
+static void shortened_code_pivots(const finite_field_t *f, int k, int s, int *pivots)
+{
+    // constraints: the leading coefficient is 0, and p(r) = 0 for r = 0..s-2
+    int C[s][k];
+    for (int j = 0; j < k; j++) C[0][j] = j == 0;
+    for (int r = 0; r < s - 1; r++)
+    {
+        for (int j = 0; j < k; j++) C[r + 1][j] = field_pow(f, r, k - 1 - j);
+    }
+    // eliminate right to left; a coordinate is a pivot of the code when
+    // it adds nothing to the rank of the constraints to its right
+    int rank = 0, num_pivots = 0;
+    for (int j = k - 1; j >= 0; j--)
+    {
+        int row = -1;
+        for (int r = rank; r < s && row < 0; r++)
+        {
+            if (C[r][j] != 0) row = r;
+        }
+        if (row < 0)
+        {
+            pivots[num_pivots++] = j;
+            continue;
+        }
+        for (int j2 = 0; j2 < k; j2++)
+        { // swap into place
+            int tmp = C[rank][j2];
+            C[rank][j2] = C[row][j2];
+            C[row][j2] = tmp;
+        }
+        int scale = field_inv(f, C[rank][j]);
+        for (int j2 = 0; j2 < k; j2++) C[rank][j2] = field_mul(f, C[rank][j2], scale);
+        for (int r = 0; r < s; r++)
+        {
+            if (r == rank || C[r][j] == 0) continue;
+            int factor = field_neg(f, C[r][j]);
+            for (int j2 = 0; j2 < k; j2++)
+            {
+                C[r][j2] = field_add(f, C[r][j2], field_mul(f, factor, C[rank][j2]));
+            }
+        }
+        rank++;
+    }
+    // they were found right to left
+    for (int i = 0; i < num_pivots / 2; i++)
+    {
+        int tmp = pivots[i];
+        pivots[i] = pivots[num_pivots - 1 - i];
+        pivots[num_pivots - 1 - i] = tmp;
+    }
+}
+
+long long reed_solomon_list_decode(const finite_field_t *f, int k, int m, int s,
+                                   const unsigned char *outcomes,
+                                   long long *positives, long long max_positives)
+{
+    int q = f->q;
+    // the rows (m - s) * q must fit in an int, like those of the CFF
+    if (k - s < 1 || m - s < k - s || s < 0 || (s > 0 && s >= k) || m > q + 1
+        || (long long) (m - s) * q > INT_MAX) return -1;
+    int K = k - s; // dimension of the (shortened) code
+    int groups = m - s; // of q rows each
+
+    // group g is evaluated at x = g - 1 (group 0 holds the leading coefficient) for
+    // the full code, and at x = g + s - 1 for the shortened one
+    int xs_all[groups], sizes[groups];
+    int *sets = malloc((size_t) groups * q * sizeof(int)); // positive symbols of each group
+    if (sets == NULL) return -1;
+    for (int g = 0; g < groups; g++)
+    {
+        xs_all[g] = s == 0 ? g - 1 : g + s - 1; // -1 is "infinity"
+        sizes[g] = 0;
+        for (int v = 0; v < q; v++)
+        {
+            int r = g * q + v;
+            if ((outcomes[r / 8] >> (r % 8)) & 1) sets[g * q + sizes[g]++] = v;
+        }
+    }
+
+    // the K groups with the fewest positive rows
+    int chosen[K];
+    bool is_chosen[groups];
+    for (int g = 0; g < groups; g++) is_chosen[g] = false;
+    for (int i = 0; i < K; i++)
+    {
+        int best = -1;
+        for (int g = 0; g < groups; g++)
+        {
+            if (!is_chosen[g] && (best < 0 || sizes[g] < sizes[best])) best = g;
+        }
+        chosen[i] = best;
+        is_chosen[best] = true;
+        if (sizes[best] == 0)
+        { // no codeword has a symbol in this group
+            free(sets);
+            return 0;
+        }
+    }
+
+    // Z(x) = x(x-1)...(x-(s-2))
+    int z_degree = s > 0 ? s - 1 : 0;
+    int Z[z_degree + 1];
+    Z[0] = 1;
+    for (int root = 0; root < s - 1; root++)
+    {
+        Z[root + 1] = 0;
+        for (int e = root + 1; e > 0; e--) Z[e] = field_add(f, Z[e-1], field_mul(f, Z[e], field_neg(f, root)));
+        Z[0] = field_mul(f, Z[0], field_neg(f, root));
+    }
+
+    // the finite points among the chosen groups; infinity (if chosen) is the leading coefficient of h
+    int infinity = -1, L = 0;
+    int xs[K];
+    for (int i = 0; i < K; i++)
+    {
+        if (xs_all[chosen[i]] < 0) infinity = chosen[i];
+        else xs[L++] = xs_all[chosen[i]];
+    }
+    int basis[K * K];
+    lagrange_basis(f, xs, L, basis);
+    int z_inverse_at[K], lead_term_at[K];
+    for (int i = 0; i < L; i++)
+    {
+        int z = 0;
+        for (int e = z_degree; e >= 0; e--) z = field_add(f, field_mul(f, z, xs[i]), Z[e]);
+        z_inverse_at[i] = field_inv(f, z);
+        lead_term_at[i] = field_pow(f, xs[i], K - 1);
+    }
+
+    int pivots[K];
+    if (s > 0) shortened_code_pivots(f, k, s, pivots);
+    else for (int i = 0; i < K; i++) pivots[i] = i;
+
+    long long capacity = 64, count = 0;
+    long long *found = malloc(capacity * sizeof(long long));
+    if (found == NULL)
+    {
+        free(sets);
+        return -1;
+    }
+    int pick[K]; // odometer over the symbols of the chosen groups
+    for (int i = 0; i < K; i++) pick[i] = 0;
+    int h[K], poly[k];
+    bool more = true;
+    while (more)
+    {
+        // interpolate h through the picked symbols
+        int lead = 0;
+        for (int i = 0; i < K; i++)
+        {
+            if (chosen[i] == infinity) lead = sets[chosen[i] * q + pick[i]];
+        }
+        for (int e = 0; e < K; e++) h[e] = 0;
+        int at = 0;
+        for (int i = 0; i < K; i++)
+        {
+            if (chosen[i] == infinity) continue;
+            int y = field_mul(f, sets[chosen[i] * q + pick[i]], z_inverse_at[at]);
+            if (infinity >= 0)
+            { // take away lead * x^(K-1), which the other K-1 points can't see
+                y = field_add(f, y, field_neg(f, field_mul(f, lead, lead_term_at[at])));
+            }
+            for (int e = 0; e < L; e++) h[e] = field_add(f, h[e], field_mul(f, y, basis[at * L + e]));
+            at++;
+        }
+        if (infinity >= 0) h[K - 1] = lead;
+
+        // p = Z * h
+        for (int e = 0; e < k; e++) poly[e] = 0;
+        for (int a = 0; a <= z_degree; a++)
+        {
+            for (int b = 0; b < K; b++)
+            {
+                poly[a + b] = field_add(f, poly[a + b], field_mul(f, Z[a], h[b]));
+            }
+        }
+
+        // every group's symbol must be in a positive row
+        bool positive = true;
+        for (int g = 0; g < groups && positive; g++)
+        {
+            int value = 0;
+            if (xs_all[g] < 0) value = poly[k - 1];
+            else for (int e = k - 1; e >= 0; e--) value = field_add(f, field_mul(f, value, xs_all[g]), poly[e]);
+            int r = g * q + value;
+            positive = (outcomes[r / 8] >> (r % 8)) & 1;
+        }
+        if (positive)
+        {
+            // the column is the rank of the coefficients (highest degree first) at the pivots
+            long long index = 0;
+            for (int i = 0; i < K; i++) index = index * q + poly[k - 1 - pivots[i]];
+            if (count == capacity)
+            {
+                capacity *= 2;
+                long long *grown = realloc(found, capacity * sizeof(long long));
+                if (grown == NULL)
+                {
+                    free(found);
+                    free(sets);
+                    return -1;
+                }
+                found = grown;
+            }
+            found[count++] = index;
+        }
+
+        more = false;
+        for (int i = K - 1; i >= 0 && !more; i--)
+        {
+            if (++pick[i] < sizes[chosen[i]]) more = true;
+            else pick[i] = 0;
+        }
+    }
+
+    // report in increasing order, like cff_decode()
+    qsort(found, count, sizeof(long long), cff_compare_long_long);
+    for (long long i = 0; i < count && i < max_positives && positives != NULL; i++)
+    {
+        positives[i] = found[i];
+    }
+    free(found);
+    free(sets);
+    return count;
+}
+
+long long cff_reed_solomon_decode(int p, int exp, int t, int m, const unsigned char *outcomes,
+                                  long long *positives, long long max_positives)
+{
+    if (outcomes == NULL) return -1;
+    finite_field_t *field = finite_field_create(p, exp);
+    if (field == NULL) return -1;
+    long long count = reed_solomon_list_decode(field, t, m, 0, outcomes, positives, max_positives);
+    finite_field_free(field);
+    return count;
+}
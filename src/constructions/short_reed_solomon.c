@@ -84,4 +84,15 @@ cff_t* cff_short_reed_solomon(int p, int exp, int k, int m, int s)
     free(addition_field);
     free(multiplication_field);
     return cff;
-}
\ No newline at end of file
+}
+
+long long cff_short_reed_solomon_decode(int p, int exp, int t, int m, int s, const unsigned char *outcomes,
+                                        long long *positives, long long max_positives)
+{
+    if (outcomes == NULL) return -1;
+    finite_field_t *field = finite_field_create(p, exp);
+    if (field == NULL) return -1;
+    long long count = reed_solomon_list_decode(field, t, m, s, outcomes, positives, max_positives);
+    finite_field_free(field);
+    return count;
+}
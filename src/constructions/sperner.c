@@ -42,4 +42,128 @@ cff_t* cff_sperner(int n)
         col++;
     } while (k_subset_lex_successor(t, t / 2, subset));
     return cff;
-}
\ No newline at end of file
+}
+
+/*
+    Ranking the columns of cff_sperner().
+
+    Column j is the j-th k-subset of the t tests in lexicographic order, with
+    k = t/2. Walking over the tests x = 0, 1, ..., t-1 with K tests still to
+    pick from the N = t - x that are left, the subsets that skip x come after
+    the C(N-1, K-1) that take it. C(N, K) is updated in place as N and K drop
+    (C(N-1, K-1) = C(N, K) K / N and C(N-1, K) = C(N, K) (N-K) / N), so both
+    directions are a single O(t) pass without any table of binomials.
+*/
+
+// the t of cff_sperner(n), with choose(t, t/2) in *central
+static int sperner_t(int n, long long *central)
+{
+    int s = 0;
+    long long c = 1; // choose(s, s/2)
+    while (c < n)
+    {
+        // choose(2h+1, h) = choose(2h, h) (2h+1) / (h+1) and
+        // choose(2h+2, h+1) = choose(2h+1, h) (2h+2) / (h+1)
+        c = c * (s + 1) / (s / 2 + 1);
+        s++;
+    }
+    *central = c;
+    return s;
+}
+
+long long cff_sperner_rank(int n, const int *tests, int num_tests)
+{
+    if (n < 1 || tests == NULL) return -1;
+    long long paths;
+    int t = sperner_t(n, &paths);
+    int K = t / 2;
+    if (num_tests != K) return -1;
+    long long rank = 0;
+    int i = 0;
+    for (int x = 0; x < t && K > 0; x++)
+    {
+        int N = t - x;
+        long long take = paths * K / N; // C(N-1, K-1)
+        if (i < num_tests && tests[i] == x)
+        {
+            paths = take;
+            K--;
+            i++;
+        } else
+        {
+            if (i < num_tests && tests[i] < x) return -1; // not increasing
+            rank += take;
+            paths -= take; // C(N-1, K)
+        }
+    }
+    if (i != num_tests || rank >= n) return -1;
+    return rank;
+}
+
+int cff_sperner_unrank(int n, long long column, int *tests)
+{
+    if (n < 1 || tests == NULL || column < 0 || column >= n) return -1;
+    long long paths;
+    int t = sperner_t(n, &paths);
+    int K = t / 2;
+    int k = 0;
+    for (int x = 0; x < t && K > 0; x++)
+    {
+        int N = t - x;
+        long long take = paths * K / N;
+        if (column < take)
+        {
+            tests[k++] = x;
+            paths = take;
+            K--;
+        } else
+        {
+            column -= take;
+            paths -= take;
+        }
+    }
+    return k;
+}
+
+long long cff_sperner_decode(int n, const unsigned char *outcomes, long long *positives, long long max_positives)
+{
+    if (n < 1 || outcomes == NULL) return -1;
+    long long central;
+    int t = sperner_t(n, &central);
+    int k = t / 2;
+    int positive_tests[t > 0 ? t : 1];
+    int num_positive = 0;
+    for (int r = 0; r < t; r++)
+    {
+        if ((outcomes[r / 8] >> (r % 8)) & 1)
+        {
+            positive_tests[num_positive++] = r;
+        }
+    }
+    if (num_positive < k) return 0;
+
+    // the positive items are the k-subsets of the positive tests; with one
+    // positive item there is exactly one. They come out in increasing order.
+    int pick[k > 0 ? k : 1];
+    int tests[k > 0 ? k : 1];
+    for (int i = 0; i < k; i++)
+    {
+        pick[i] = i;
+    }
+    long long count = 0;
+    do
+    {
+        for (int i = 0; i < k; i++)
+        {
+            tests[i] = positive_tests[pick[i]];
+        }
+        long long column = cff_sperner_rank(n, tests, k);
+        if (column == -1) break; // past the n columns, and so are all later subsets
+        if (count < max_positives && positives != NULL)
+        {
+            positives[count] = column;
+        }
+        count++;
+    } while (k > 0 && k_subset_lex_successor(num_positive, k, pick));
+    return count;
+}
@@ -192,3 +192,175 @@ cff_t* cff_sts(int v)
     free(sts);
     return cff;
 }
+
+int sts_row_automorphisms(int v, int **perms)
+{
+    *perms = NULL;
+    if (v % 6 != 1 && v % 6 != 3) return 0;
+    // both constructions use the points x + Q*i for i = 0, 1, 2 (plus a point at infinity
+    // for Skolem), and are invariant under i -> i+1. Bose's quasigroup is also invariant
+    // under x -> x+1
+    int Q = v % 6 == 3 ? v / 3 : (v - 1) / 3;
+    int count = v % 6 == 3 ? 2 : 1;
+    *perms = malloc((size_t) count * v * sizeof(int));
+    if (*perms == NULL) return -1;
+    int *shift_i = *perms;
+    for (int r = 0; r < v; r++)
+    {
+        shift_i[r] = r < 3 * Q ? (r + Q) % (3 * Q) : r;
+    }
+    if (count == 2)
+    {
+        int *shift_x = *perms + v;
+        for (int r = 0; r < v; r++)
+        {
+            shift_x[r] = (r / Q) * Q + ((r % Q) + 1) % Q;
+        }
+    }
+    return count;
+}
+
+
+/*
+    Decoding a Steiner triple system.
+
+    Every pair of points is in exactly one block, so the blocks with all three
+    points in positive tests are found from the pairs of positive tests alone.
+    Point x + Q*i (row x + Q*i) is x at level i. A pair at one level is the
+    type 2 (Bose) or type 3 (Skolem) block {x_i, y_i, (x o y)_(i+1)}. A pair
+    u_i, z_(i+1) is either a type 1 block {x_0, x_1, x_2}, or the block of the
+    w with u o w = z, and w comes from inverting the quasigroup's formula:
+        Bose:   u o w = (Q+1)/2 (u + w), so w = 2z - u (mod Q)
+        Skolem: u o w is (u + w)/2 or ((u + w) + Q - 1)/2 by the parity of
+                u + w (mod Q), so u + w = 2z when z < Q/2 and 2z - Q + 1 otherwise.
+    When the Skolem w is u itself, the pair is in the type 2 block through the
+    point at infinity. Block indices count the blocks the constructions above
+    create before it.
+*/
+
+typedef struct
+{
+    int Q;        // order of the quasigroup
+    int n;        // v = 6n + 3 (Bose) or 6n + 1 (Skolem)
+    bool skolem;
+} sts_shape_t;
+
+// the row of point x at level i
+static int sts_row(const sts_shape_t *shape, int x, int i)
+{
+    return x + shape->Q * (i % 3);
+}
+
+// index of the first block the constructions create for quasigroup row x
+static long long sts_block_base(const sts_shape_t *shape, int x)
+{
+    long long Q = shape->Q;
+    long long type3 = 3 * ((long long) x * (Q - 1) - ((long long) x * (x - 1)) / 2);
+    if (shape->skolem) return 4LL * shape->n + type3;
+    return x + type3; // one type 1 block per earlier row
+}
+
+// index of the block {x_i, y_i, (x o y)_(i+1)} for x < y
+static long long sts_pair_block(const sts_shape_t *shape, int x, int y, int i)
+{
+    long long offset = 3LL * (y - x - 1) + i;
+    if (!shape->skolem) offset++; // after the type 1 block of row x
+    return sts_block_base(shape, x) + offset;
+}
+
+// finds the block through rows a and b: its index and its third row
+static void sts_block_through(const sts_shape_t *shape, int v, int a, int b, long long *block, int *third)
+{
+    int Q = shape->Q;
+    int (*ball)(int, int, int) = shape->skolem ? halfIdempotentQuasiGroupFunction
+                                               : symmetricIdempotentQuasiGroupFunction;
+    int inf = v - 1;
+    if (shape->skolem && (a == inf || b == inf))
+    { // type 2: {inf, (n + x)_i, x_(i+1)} for x < n
+        int r = a == inf ? b : a;
+        int p = r % Q, i = r / Q;
+        int x = p >= shape->n ? p - shape->n : p;
+        if (p < shape->n) i = (i + 2) % 3;
+        *block = 4LL * x + 1 + i;
+        *third = p >= shape->n ? sts_row(shape, x, i + 1) : sts_row(shape, shape->n + x, i);
+        return;
+    }
+    int xa = a % Q, ia = a / Q, xb = b % Q, ib = b / Q;
+    if (ia == ib)
+    {
+        int x = xa < xb ? xa : xb, y = xa < xb ? xb : xa;
+        *block = sts_pair_block(shape, x, y, ia);
+        *third = sts_row(shape, ball(Q, x, y), ia + 1);
+        return;
+    }
+    // orient the pair as u at level i and z at level i+1
+    int u = xa, z = xb, i = ia;
+    if ((ia + 1) % 3 != ib)
+    {
+        u = xb;
+        z = xa;
+        i = ib;
+    }
+    if (u == z && (!shape->skolem || u < shape->n))
+    { // type 1
+        *block = shape->skolem ? 4LL * u : sts_block_base(shape, u);
+        *third = sts_row(shape, u, 3 - ia - ib);
+        return;
+    }
+    int sum = shape->skolem ? (z < Q / 2 ? 2 * z : 2 * z - Q + 1) : 2 * z;
+    int w = ((sum - u) % Q + Q) % Q;
+    if (w == u)
+    { // Skolem type 2 through infinity: u = n + z
+        *block = 4LL * z + 1 + i;
+        *third = inf;
+        return;
+    }
+    int x = u < w ? u : w, y = u < w ? w : u;
+    *block = sts_pair_block(shape, x, y, i);
+    *third = sts_row(shape, w, i);
+}
+
+long long cff_sts_decode(int v, const unsigned char *outcomes, long long *positives, long long max_positives)
+{
+    if (outcomes == NULL) return -1;
+    if (v % 6 != 1 && v % 6 != 3) return -1;
+    sts_shape_t shape;
+    shape.skolem = v % 6 == 1;
+    shape.n = shape.skolem ? (v - 1) / 6 : (v - 3) / 6;
+    shape.Q = shape.skolem ? 2 * shape.n : 2 * shape.n + 1;
+
+    int positive_rows[v];
+    int num_positive = 0;
+    for (int r = 0; r < v; r++)
+    {
+        if ((outcomes[r / 8] >> (r % 8)) & 1)
+        {
+            positive_rows[num_positive++] = r;
+        }
+    }
+    // a positive block is found once, from its two lowest rows
+    long long max_found = (long long) num_positive * (num_positive - 1) / 2;
+    long long *found = malloc((size_t) (max_found > 0 ? max_found : 1) * sizeof(long long));
+    if (found == NULL) return -1;
+    long long count = 0;
+    for (int i = 0; i < num_positive; i++)
+    {
+        for (int j = i + 1; j < num_positive; j++)
+        {
+            long long block;
+            int third;
+            sts_block_through(&shape, v, positive_rows[i], positive_rows[j], &block, &third);
+            if (third > positive_rows[j] && ((outcomes[third / 8] >> (third % 8)) & 1))
+            {
+                found[count++] = block;
+            }
+        }
+    }
+    qsort(found, count, sizeof(long long), cff_compare_long_long);
+    for (long long i = 0; i < count && i < max_positives && positives != NULL; i++)
+    {
+        positives[i] = found[i];
+    }
+    free(found);
+    return count;
+}
@@ -0,0 +1,6 @@
+#include "cff_internals.h"
+
+// no embedded tables, for the table generator itself and for builds with CFF_EMBED_TABLES off
+const int cff_embedded_num_tables = 0;
+const cff_embedded_table_t cff_embedded_tables[1] = {{0, 0, 0}};
+const cff_embedded_row_t cff_embedded_rows[1] = {{0, 0, 0, {0, 0, 0, 0, 0}}};
@@ -0,0 +1,86 @@
+#include "../include/libcfftables/libcfftables.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cff_internals.h"
+
+/*
+    Writes the C source of the tables embedded in the library (see
+    cff_internals.h). This is linked without embedded tables, so the tables
+    it writes are built by cff_table_create().
+*/
+
+// whether a row is the one the library rebuilds when it is not stored
+static bool is_default_row(const cff_table_t *table, int t)
+{
+    cff_table_row_t expected;
+    cff_embedded_default_row(table->d, t, &table->array[t-1], &expected);
+    const cff_table_row_t *row = &table->array[t];
+    return row->n == expected.n && row->constructionID == expected.constructionID
+           && memcmp(row->consParams, expected.consParams, sizeof(expected.consParams)) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s <output.c>\n", argv[0]);
+        return 1;
+    }
+    cff_table_ctx_t *ctx = cff_table_create(CFF_EMBEDDED_D_MAX, CFF_EMBEDDED_T_MAX, CFF_EMBEDDED_N_MAX);
+    for (int d = 2; d <= ctx->d_max; d++)
+    {
+        const cff_table_t *table = ctx->tables_array[d-1];
+        if (table->array[table->numCFFs - 1].n != CFF_EMBEDDED_N_MAX)
+        {
+            fprintf(stderr, "the %d-CFF table does not reach n = %lld, raise CFF_EMBEDDED_T_MAX\n",
+                    d, CFF_EMBEDDED_N_MAX);
+            return 1;
+        }
+    }
+    FILE *fptr = fopen(argv[1], "w");
+    if (fptr == NULL)
+    {
+        fprintf(stderr, "cannot write %s\n", argv[1]);
+        return 1;
+    }
+    fprintf(fptr, "// generated by generate_embedded_tables.c, do not edit\n\n");
+    fprintf(fptr, "#include \"cff_internals.h\"\n\n");
+    fprintf(fptr, "const int cff_embedded_num_tables = %d;\n\n", ctx->d_max - 1);
+
+    fprintf(fptr, "const cff_embedded_table_t cff_embedded_tables[] = {\n");
+    int first_row = 0;
+    for (int d = 2; d <= ctx->d_max; d++)
+    {
+        const cff_table_t *table = ctx->tables_array[d-1];
+        int num_rows = 0;
+        for (int t = 1; t < table->numCFFs; t++)
+        {
+            num_rows += !is_default_row(table, t);
+        }
+        fprintf(fptr, "    {%d, %d, %d}, // d = %d\n", table->numCFFs, first_row, num_rows, d);
+        first_row += num_rows;
+    }
+    fprintf(fptr, "};\n\n");
+
+    fprintf(fptr, "const cff_embedded_row_t cff_embedded_rows[] = {\n");
+    for (int d = 2; d <= ctx->d_max; d++)
+    {
+        const cff_table_t *table = ctx->tables_array[d-1];
+        for (int t = 1; t < table->numCFFs; t++)
+        {
+            if (is_default_row(table, t)) continue;
+            const cff_table_row_t *row = &table->array[t];
+            fprintf(fptr, "    {%lldLL, %d, %hd, {%hd, %hd, %hd, %hd, %hd}},\n", row->n, t,
+                    row->constructionID, row->consParams[0], row->consParams[1], row->consParams[2],
+                    row->consParams[3], row->consParams[4]);
+        }
+    }
+    fprintf(fptr, "};\n");
+    int failed = fclose(fptr) != 0;
+    cff_table_free(ctx);
+    return failed;
+}
@@ -3,6 +3,8 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
 
 
 /*
@@ -30,8 +32,8 @@ long long choose(int n, int k)
         return 1;
     }
 
-    long long a[k+1]; // previous row of pascal's triangle
-    long long b[k+1]; // current row of pascal's triangle
+    long long a[k+2]; // previous row of pascal's triangle (+1 for the trailing 1 written below)
+    long long b[k+2]; // current row of pascal's triangle
 
     long long *a_ptr, *b_ptr, *swap_ptr;
     a_ptr = a;
@@ -46,12 +48,12 @@ long long choose(int n, int k)
         int col; // (iniitialize outside for loop so its value can be accessed after)
         for (col = 1; col < row && col < k + 1; col++)
         {
-            b_ptr[col] = a_ptr[col-1] + a_ptr[col];
-            // returns 0 if overflow occurred during the addition in above line
-            if (b_ptr[col] < a_ptr[col-1] || b_ptr[col] < a_ptr[col])
+            // returns 0 if the addition below would overflow
+            if (a_ptr[col-1] > LLONG_MAX - a_ptr[col])
             {
                 return 0;
             }
+            b_ptr[col] = a_ptr[col-1] + a_ptr[col];
         }
         b_ptr[col] = 1;
         swap_ptr = a_ptr;
@@ -99,6 +101,25 @@ bool k_subset_lex_successor(int n, int k, int *buffer)
     return false;
 }
 
+// Inverse of counting k_subset_lex_successor() steps from {0, 1, ..., k-1}:
+// element i is the first x whose subsets (those starting with x) reach past rank.
+void k_subset_lex_unrank(int n, int k, long long rank, int *buffer)
+{
+    int x = 0;
+    for (int i = 0; i < k; i++)
+    {
+        long long with_x = choose(n - 1 - x, k - 1 - i);
+        while (rank >= with_x)
+        {
+            rank -= with_x;
+            x++;
+            with_x = choose(n - 1 - x, k - 1 - i);
+        }
+        buffer[i] = x;
+        x++;
+    }
+}
+
 bool k_tuple_lex_successor(int n, int k, int *buffer)
 {
     for (int i = k-1; i > -1; i--)
@@ -152,4 +173,136 @@ void prime_sieve(int n, bool *prime_array)
             }
         }
     }
-}
\ No newline at end of file
+}
+
+void smallest_factor_sieve(int n, int *factor)
+{
+    for (int i = 0; i <= n; i++)
+    {
+        factor[i] = i;
+    }
+    for (int p = 2; (long long) p * p <= n; p++)
+    {
+        if (factor[p] == p)
+        {
+            for (int i = p * p; i <= n; i += p)
+            {
+                if (factor[i] == i) factor[i] = p;
+            }
+        }
+    }
+}
+
+int cff_compare_long_long(const void *a, const void *b)
+{
+    long long x = *(const long long *) a, y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+uint64_t* cff_pack_columns(const cff_t *cff, int *words_per_column)
+{
+    int w = (cff->t + 63) / 64;
+    if (w == 0) w = 1;
+    uint64_t *packed = calloc((size_t) cff->n * w, sizeof(uint64_t));
+    if (packed == NULL) return NULL;
+    long long row_bytes = cff->stride_bits / 8;
+    long long used_bytes = (cff->n + 7) / 8;
+    for (int r = 0; r < cff->t; r++)
+    {
+        const unsigned char *row = cff->matrix + r * row_bytes;
+        uint64_t bit = (uint64_t) 1 << (r % 64);
+        int word = r / 64;
+        for (long long byte = 0; byte < used_bytes; byte++)
+        {
+            // only visit the set cells of the row
+            unsigned int v = row[byte];
+            while (v)
+            {
+                long long c = byte * 8 + lowest_bit64(v);
+                if (c >= cff->n) break; // bits past n (e.g. after cff_reduce_n())
+                packed[c * w + word] |= bit;
+                v &= v - 1;
+            }
+        }
+    }
+    *words_per_column = w;
+    return packed;
+}
+
+void cff_recipe_free(cff_recipe_t *recipe)
+{
+    if (recipe == NULL) return;
+    for (int i = 0; i < recipe->num_children; i++)
+    {
+        cff_recipe_free(recipe->children[i]);
+    }
+    free(recipe);
+}
+
+cff_recipe_t* cff_recipe_copy(const cff_recipe_t *recipe)
+{
+    if (recipe == NULL) return NULL;
+    cff_recipe_t *copy = malloc(sizeof(cff_recipe_t));
+    if (copy == NULL) return NULL;
+    *copy = *recipe;
+    for (int i = 0; i < recipe->num_children; i++)
+    {
+        copy->children[i] = cff_recipe_copy(recipe->children[i]);
+        if (copy->children[i] == NULL)
+        {
+            copy->num_children = i;
+            cff_recipe_free(copy);
+            return NULL;
+        }
+    }
+    return copy;
+}
+
+void cff_attach_product_recipe(cff_t *product, short constructionID, const short params[5],
+                               const cff_t *const *inputs, int num_inputs)
+{
+    if (product == NULL) return;
+    for (int i = 0; i < num_inputs; i++)
+    {
+        const cff_recipe_t *recipe = inputs[i]->recipe;
+        if (recipe == NULL) return;
+        if (recipe->t != inputs[i]->t || recipe->n != inputs[i]->n) return;
+        if (cff_matrix_checksum(inputs[i]) != inputs[i]->matrix_checksum) return;
+    }
+    cff_recipe_t *node = malloc(sizeof(cff_recipe_t));
+    if (node == NULL) return; // the product is still fine, it just can't be decoded by construction
+    node->constructionID = constructionID;
+    for (int i = 0; i < 5; i++)
+    {
+        node->consParams[i] = params[i];
+    }
+    node->d = product->d;
+    node->t = product->t;
+    node->n = product->n;
+    node->num_children = 0;
+    for (int i = 0; i < num_inputs; i++)
+    {
+        node->children[i] = cff_recipe_copy(inputs[i]->recipe);
+        if (node->children[i] == NULL)
+        {
+            cff_recipe_free(node);
+            return;
+        }
+        node->num_children++;
+    }
+    cff_recipe_free(product->recipe);
+    product->recipe = node;
+    product->matrix_checksum = cff_matrix_checksum(product);
+}
+
+uint64_t cff_matrix_checksum(const cff_t *cff)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    long long num_bytes = (cff->stride_bits / 8) * cff->t;
+    for (long long i = 0; i < num_bytes; i++)
+    {
+        hash ^= cff->matrix[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
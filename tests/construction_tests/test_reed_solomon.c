@@ -1,7 +1,51 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <libcfftables/libcfftables.h>
 
+// the packed outcomes of the tests of a CFF when the given items are positive
+static void encode(const cff_t *cff, const long long *items, int num_items, unsigned char *outcomes)
+{
+    int t = cff_get_t(cff);
+    memset(outcomes, 0, (t + 7) / 8);
+    for (int r = 0; r < t; r++)
+    {
+        for (int i = 0; i < num_items; i++)
+        {
+            if (cff_get_matrix_value(cff, r, (int) items[i]) == 1)
+            {
+                outcomes[r / 8] |= 1 << (r % 8);
+            }
+        }
+    }
+}
+
+// decodes random positive sets (up to d+2 items) both ways and compares
+static void check_decoder_matches_cff_decode(const cff_t *cff, int p, int exp, int k, int m, int s)
+{
+    unsigned char outcomes[(cff_get_t(cff) + 7) / 8];
+    long long items[16], expected[1024], decoded[1024];
+    for (int trial = 0; trial < 40; trial++)
+    {
+        int num_items = rand() % (cff_get_d(cff) + 3);
+        for (int i = 0; i < num_items; i++)
+        {
+            items[i] = rand() % cff_get_n(cff);
+        }
+        encode(cff, items, num_items, outcomes);
+        long long count = cff_decode(cff, outcomes, expected, 1024);
+        long long got = s == 0
+            ? cff_reed_solomon_decode(p, exp, k, m, outcomes, decoded, 1024)
+            : cff_short_reed_solomon_decode(p, exp, k, m, s, outcomes, decoded, 1024);
+        assert(got == count);
+        for (int i = 0; i < count && i < 1024; i++)
+        {
+            assert(decoded[i] == expected[i]);
+        }
+    }
+}
+
 
 void test_cff_reed_solomon_1()
 {
@@ -29,10 +73,54 @@ void test_cff_reed_solomon_2()
     puts("OK test_cff_reed_solomon_2 passed");
 }
 
+// the list decoder agrees with cff_decode, over prime and non-prime fields
+void test_cff_reed_solomon_decode()
+{
+    puts("Running test_cff_reed_solomon_decode...");
+    srand(34);
+    int params[][4] = {{5,1,2,4}, {2,3,2,5}, {7,1,3,7}, {3,2,2,10}, {2,2,3,5}, {5,1,2,2}};
+    for (int i = 0; i < 6; i++)
+    {
+        cff_t *cff = cff_reed_solomon(params[i][0], params[i][1], params[i][2], params[i][3]);
+        check_decoder_matches_cff_decode(cff, params[i][0], params[i][1], params[i][2], params[i][3], 0);
+        cff_free(cff);
+    }
+    puts("OK test_cff_reed_solomon_decode passed");
+}
+
+// a code over a large prime field, far too big to build: codeword c1 * q + c0 is the polynomial
+// c1 x + c0, with c1 in group 0 and its value at x = g - 1 in group g
+void test_cff_reed_solomon_decode_large_field()
+{
+    puts("Running test_cff_reed_solomon_decode_large_field...");
+    const int q = 65537, m = 3; // a 2-CFF(3q, q^2)
+    unsigned char *outcomes = calloc((m * q + 7) / 8, 1);
+    assert(outcomes != NULL);
+    long long items[2] = {123456789LL, 4000000000LL};
+    for (int i = 0; i < 2; i++)
+    {
+        long long c1 = items[i] / q, c0 = items[i] % q;
+        for (int g = 0; g < m; g++)
+        {
+            long long r = g == 0 ? c1 : g * q + (c1 * (g - 1) + c0) % q;
+            outcomes[r / 8] |= 1 << (r % 8);
+        }
+    }
+    long long decoded[8];
+    assert(cff_reed_solomon_decode(q, 1, 2, m, outcomes, decoded, 8) == 2);
+    assert(decoded[0] == items[0] && decoded[1] == items[1]);
+    // q^2 does not fit in an int, so there are too many tests
+    assert(cff_reed_solomon_decode(q, 2, 2, m, outcomes, decoded, 8) == -1);
+    free(outcomes);
+    puts("OK test_cff_reed_solomon_decode_large_field passed");
+}
+
 int main()
 {
     test_cff_reed_solomon_1();
     test_cff_reed_solomon_2();
+    test_cff_reed_solomon_decode();
+    test_cff_reed_solomon_decode_large_field();
 
     puts("ALL test_reed_solomon passed");
     return 0;
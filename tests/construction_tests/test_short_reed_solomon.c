@@ -1,7 +1,51 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <libcfftables/libcfftables.h>
 
+// the packed outcomes of the tests of a CFF when the given items are positive
+static void encode(const cff_t *cff, const long long *items, int num_items, unsigned char *outcomes)
+{
+    int t = cff_get_t(cff);
+    memset(outcomes, 0, (t + 7) / 8);
+    for (int r = 0; r < t; r++)
+    {
+        for (int i = 0; i < num_items; i++)
+        {
+            if (cff_get_matrix_value(cff, r, (int) items[i]) == 1)
+            {
+                outcomes[r / 8] |= 1 << (r % 8);
+            }
+        }
+    }
+}
+
+// decodes random positive sets (up to d+2 items) both ways and compares
+static void check_decoder_matches_cff_decode(const cff_t *cff, int p, int exp, int k, int m, int s)
+{
+    unsigned char outcomes[(cff_get_t(cff) + 7) / 8];
+    long long items[16], expected[1024], decoded[1024];
+    for (int trial = 0; trial < 40; trial++)
+    {
+        int num_items = rand() % (cff_get_d(cff) + 3);
+        for (int i = 0; i < num_items; i++)
+        {
+            items[i] = rand() % cff_get_n(cff);
+        }
+        encode(cff, items, num_items, outcomes);
+        long long count = cff_decode(cff, outcomes, expected, 1024);
+        long long got = s == 0
+            ? cff_reed_solomon_decode(p, exp, k, m, outcomes, decoded, 1024)
+            : cff_short_reed_solomon_decode(p, exp, k, m, s, outcomes, decoded, 1024);
+        assert(got == count);
+        for (int i = 0; i < count && i < 1024; i++)
+        {
+            assert(decoded[i] == expected[i]);
+        }
+    }
+}
+
 // try shortening a RS code by 1
 void test_cff_short_reed_solomon_1()
 {
@@ -32,10 +76,26 @@ void test_cff_short_reed_solomon_2()
 
 // note: these are testing bad CFFs that have n < t, these wouldnt appear in the tables
 // (short RS never appears in the tables)
+// the list decoder agrees with cff_decode, and numbers the codewords the same way
+void test_cff_short_reed_solomon_decode()
+{
+    puts("Running test_cff_short_reed_solomon_decode...");
+    srand(34);
+    int params[][5] = {{5,1,2,4,1}, {11,1,3,7,2}, {7,1,4,8,2}, {2,2,3,5,1}, {3,2,4,9,3}, {5,1,3,6,1}};
+    for (int i = 0; i < 6; i++)
+    {
+        cff_t *cff = cff_short_reed_solomon(params[i][0], params[i][1], params[i][2], params[i][3], params[i][4]);
+        check_decoder_matches_cff_decode(cff, params[i][0], params[i][1], params[i][2], params[i][3], params[i][4]);
+        cff_free(cff);
+    }
+    puts("OK test_cff_short_reed_solomon_decode passed");
+}
+
 int main()
 {
     test_cff_short_reed_solomon_1();
     test_cff_short_reed_solomon_2();
+    test_cff_short_reed_solomon_decode();
 
     puts("ALL test_short_reed_solomon passed");
     return 0;
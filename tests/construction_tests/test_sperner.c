@@ -1,4 +1,6 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <libcfftables/libcfftables.h>
 
@@ -39,11 +41,97 @@ void test_cff_sperner_3()
     puts("OK test_cff_sperner_3 passed");
 }
 
+// ranking and unranking agree with the columns of the matrix
+void test_cff_sperner_rank()
+{
+    puts("Running test_cff_sperner_rank...");
+    int sizes[] = {1, 5, 6, 20, 70, 100, 1000};
+    for (int i = 0; i < 7; i++)
+    {
+        int n = sizes[i];
+        cff_t *cff = cff_sperner(n);
+        int t = cff_get_t(cff);
+        int tests[32];
+        for (long long c = 0; c < n; c++)
+        {
+            assert(cff_sperner_unrank(n, c, tests) == t / 2);
+            int k = 0;
+            for (int r = 0; r < t; r++)
+            {
+                if (cff_get_matrix_value(cff, r, (int) c) == 1)
+                {
+                    assert(tests[k++] == r);
+                }
+            }
+            assert(k == t / 2);
+            assert(cff_sperner_rank(n, tests, k) == c);
+        }
+        assert(cff_sperner_unrank(n, n, tests) == -1);
+        cff_free(cff);
+    }
+    // no matrix needed for large n: t = 34 tests for 2^31 - 1 columns
+    int n = 2147483647;
+    int tests[17];
+    long long columns[] = {0, 12345678, 2147483646};
+    for (int i = 0; i < 3; i++)
+    {
+        assert(cff_sperner_unrank(n, columns[i], tests) == 17);
+        assert(cff_sperner_rank(n, tests, 17) == columns[i]);
+    }
+    int not_increasing[] = {1, 0};
+    assert(cff_sperner_rank(6, not_increasing, 2) == -1);
+    assert(cff_sperner_rank(6, not_increasing, 1) == -1);
+    puts("OK test_cff_sperner_rank passed");
+}
+
+// the decoder agrees with cff_decode, for one positive item and for several
+void test_cff_sperner_decode()
+{
+    puts("Running test_cff_sperner_decode...");
+    srand(36);
+    int sizes[] = {6, 20, 100, 1000};
+    for (int i = 0; i < 4; i++)
+    {
+        int n = sizes[i];
+        cff_t *cff = cff_sperner(n);
+        int t = cff_get_t(cff);
+        unsigned char outcomes[4];
+        long long expected[1000], decoded[1000];
+        for (int trial = 0; trial < 50; trial++)
+        {
+            int num_items = 1 + trial % 3;
+            memset(outcomes, 0, sizeof(outcomes));
+            for (int j = 0; j < num_items; j++)
+            {
+                int item = rand() % n;
+                for (int r = 0; r < t; r++)
+                {
+                    if (cff_get_matrix_value(cff, r, item) == 1) outcomes[r / 8] |= 1 << (r % 8);
+                }
+                if (num_items == 1)
+                {
+                    assert(cff_sperner_decode(n, outcomes, decoded, 1000) == 1);
+                    assert(decoded[0] == item);
+                }
+            }
+            long long count = cff_decode(cff, outcomes, expected, 1000);
+            assert(cff_sperner_decode(n, outcomes, decoded, 1000) == count);
+            assert(memcmp(decoded, expected, count * sizeof(long long)) == 0);
+        }
+        memset(outcomes, 0, sizeof(outcomes));
+        assert(cff_sperner_decode(n, outcomes, NULL, 0) == 0);
+        cff_free(cff);
+    }
+    puts("OK test_cff_sperner_decode passed");
+}
+
 int main()
 {
     test_cff_sperner_1();
     test_cff_sperner_2();
     test_cff_sperner_3();
+    test_cff_sperner_rank();
+    test_cff_sperner_decode();
 
     puts("ALL test_sperner passed");
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <libcfftables/libcfftables.h>
 
@@ -40,10 +42,58 @@ void test_cff_sts_3()
 }
 
 
+// the pair lookup decoder agrees with cff_decode, for both constructions
+void test_cff_sts_decode()
+{
+    puts("Running test_cff_sts_decode...");
+    srand(37);
+    int orders[] = {3, 7, 9, 13, 15, 19, 21, 25, 31, 33};
+    for (int i = 0; i < 10; i++)
+    {
+        int v = orders[i];
+        cff_t *cff = cff_sts(v);
+        int n = (int) cff_get_n(cff);
+        unsigned char outcomes[5];
+        long long expected[200], decoded[200];
+        // every pair of positive items (and every single one) comes back exactly
+        for (int a = 0; a < n; a++)
+        {
+            for (int b = a; b < n; b++)
+            {
+                memset(outcomes, 0, sizeof(outcomes));
+                for (int r = 0; r < v; r++)
+                {
+                    if (cff_get_matrix_value(cff, r, a) == 1 || cff_get_matrix_value(cff, r, b) == 1)
+                    {
+                        outcomes[r / 8] |= 1 << (r % 8);
+                    }
+                }
+                long long count = cff_sts_decode(v, outcomes, decoded, 200);
+                assert(count == (a == b ? 1 : 2));
+                assert(decoded[0] == a && decoded[count - 1] == b);
+            }
+        }
+        // and any outcomes give the same as cff_decode
+        for (int trial = 0; trial < 100; trial++)
+        {
+            for (int j = 0; j < 5; j++) outcomes[j] = rand() & rand() & 0xff;
+            if (trial % 10 == 0) memset(outcomes, 0xff, sizeof(outcomes));
+            long long count = cff_decode(cff, outcomes, expected, 200);
+            assert(cff_sts_decode(v, outcomes, decoded, 200) == count);
+            assert(memcmp(decoded, expected, (count < 200 ? count : 200) * sizeof(long long)) == 0);
+        }
+        cff_free(cff);
+    }
+    unsigned char outcomes[1] = {0};
+    assert(cff_sts_decode(11, outcomes, NULL, 0) == -1);
+    puts("OK test_cff_sts_decode passed");
+}
+
 int main()
 {
     test_cff_sts_1();
     test_cff_sts_2();
     test_cff_sts_3();
+    test_cff_sts_decode();
     puts("ALL test_sts passed");
 }
\ No newline at end of file
@@ -0,0 +1,553 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <libcfftables/libcfftables.h>
+
+// the packed outcomes of the tests of a CFF when the given items are positive
+static void encode(const cff_t *cff, const long long *items, int num_items, unsigned char *outcomes)
+{
+    int t = cff_get_t(cff);
+    memset(outcomes, 0, (t + 7) / 8);
+    for (int r = 0; r < t; r++)
+    {
+        for (int i = 0; i < num_items; i++)
+        {
+            if (cff_get_matrix_value(cff, r, (int) items[i]) == 1)
+            {
+                outcomes[r / 8] |= 1 << (r % 8);
+            }
+        }
+    }
+}
+
+static int compare_long_long(const void *a, const void *b)
+{
+    long long x = *(const long long *) a, y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+// picks num_items distinct random items in increasing order
+static void random_items(long long n, long long *items, int num_items)
+{
+    for (int i = 0; i < num_items; i++)
+    {
+        bool fresh;
+        do
+        {
+            items[i] = rand() % n;
+            fresh = true;
+            for (int j = 0; j < i; j++) fresh &= items[j] != items[i];
+        } while (!fresh);
+    }
+    qsort(items, num_items, sizeof(long long), compare_long_long);
+}
+
+// up to d positives are decoded exactly, for CFFs of several shapes
+void test_cff_decode_1()
+{
+    puts("Running test_cff_decode_1...");
+    srand(31);
+    cff_t *cffs[] = {
+        cff_sts(15),                    // 2-CFF(15,35)
+        cff_reed_solomon(7, 1, 2, 7),   // 3-CFF(49,49)
+        cff_reed_solomon(11, 1, 2, 12), // 11-CFF(132,121), rows longer than 64 columns
+        cff_identity(4, 200)
+    };
+    for (int i = 0; i < 4; i++)
+    {
+        cff_t *cff = cffs[i];
+        unsigned char outcomes[(cff_get_t(cff) + 7) / 8];
+        long long items[16], decoded[16];
+        for (int trial = 0; trial < 50; trial++)
+        {
+            int num_items = rand() % (cff_get_d(cff) + 1);
+            random_items(cff_get_n(cff), items, num_items);
+            encode(cff, items, num_items, outcomes);
+            assert(cff_decode(cff, outcomes, decoded, 16) == num_items);
+            for (int j = 0; j < num_items; j++)
+            {
+                assert(decoded[j] == items[j]);
+            }
+        }
+        cff_free(cff);
+    }
+    puts("OK test_cff_decode_1 passed");
+}
+
+// more than d positives: every positive is reported, and the count exceeds d
+void test_cff_decode_2()
+{
+    puts("Running test_cff_decode_2...");
+    cff_t *cff = cff_sts(9); // 2-CFF(9,12)
+    unsigned char outcomes[2];
+    // all tests positive: every item is a candidate
+    memset(outcomes, 0xff, 2);
+    assert(cff_decode(cff, outcomes, NULL, 0) == 12);
+    // no tests positive: no candidates
+    memset(outcomes, 0, 2);
+    assert(cff_decode(cff, outcomes, NULL, 0) == 0);
+
+    long long items[] = {0, 4, 7, 11};
+    long long decoded[12];
+    encode(cff, items, 4, outcomes);
+    long long count = cff_decode(cff, outcomes, decoded, 12);
+    assert(count >= 4);
+    for (int i = 0; i < 4; i++)
+    {
+        bool found = false;
+        for (int j = 0; j < count; j++) found |= decoded[j] == items[i];
+        assert(found);
+    }
+    // only max_positives are written
+    long long first[2] = {-1, -1};
+    assert(cff_decode(cff, outcomes, first, 1) == count);
+    assert(first[0] == decoded[0] && first[1] == -1);
+    cff_free(cff);
+    puts("OK test_cff_decode_2 passed");
+}
+
+// batches of several sizes decode like cff_decode on each vector
+void test_cff_decode_batch()
+{
+    puts("Running test_cff_decode_batch...");
+    srand(33);
+    cff_t *cff = cff_reed_solomon(11, 1, 2, 12); // 11-CFF(132,121)
+    int t = cff_get_t(cff);
+    int sizes[] = {1, 64, 100};
+    for (int s = 0; s < 3; s++)
+    {
+        int batch_size = sizes[s];
+        int W = (batch_size + 63) / 64;
+        uint64_t *sliced = calloc((size_t) t * W, sizeof(uint64_t));
+        unsigned char (*outcomes)[(132 + 7) / 8] = malloc((size_t) batch_size * ((132 + 7) / 8));
+        for (int b = 0; b < batch_size; b++)
+        {
+            long long items[14];
+            int num_items = rand() % 14; // sometimes more than d
+            random_items(cff_get_n(cff), items, num_items);
+            encode(cff, items, num_items, outcomes[b]);
+            for (int r = 0; r < t; r++)
+            {
+                if ((outcomes[b][r / 8] >> (r % 8)) & 1)
+                {
+                    sliced[r * W + b / 64] |= (uint64_t) 1 << (b % 64);
+                }
+            }
+        }
+        long long *positives = malloc((size_t) batch_size * 20 * sizeof(long long));
+        long long *counts = malloc((size_t) batch_size * sizeof(long long));
+        assert(cff_decode_batch(cff, sliced, batch_size, positives, 20, counts) == 0);
+        for (int b = 0; b < batch_size; b++)
+        {
+            long long decoded[121];
+            long long count = cff_decode(cff, outcomes[b], decoded, 121);
+            assert(counts[b] == count);
+            for (int i = 0; i < count && i < 20; i++)
+            {
+                assert(positives[b * 20 + i] == decoded[i]);
+            }
+        }
+        free(sliced);
+        free(outcomes);
+        free(positives);
+        free(counts);
+    }
+    cff_free(cff);
+    puts("OK test_cff_decode_batch passed");
+}
+
+// decoding by construction agrees with cff_decode() on the CFFs of the tables,
+// for up to d positives and for more than d
+void test_cff_decode_by_construction()
+{
+    puts("Running test_cff_decode_by_construction...");
+    srand(35);
+    cff_table_ctx_t *ctx = cff_table_create(3, 100, 2000);
+    for (int d = 2; d <= 3; d++)
+    {
+        for (int t = d + 2; t <= 100; t += 3)
+        {
+            cff_t *cff = cff_table_get_by_t(ctx, d, t);
+            if (cff == NULL) continue;
+            long long n = cff_get_n(cff);
+            unsigned char outcomes[(100 + 7) / 8];
+            long long items[6], expected[2000], decoded[2000];
+            for (int trial = 0; trial < 4; trial++)
+            {
+                int num_items = 1 + trial + (d - 1);
+                if (num_items > n) num_items = (int) n;
+                random_items(n, items, num_items);
+                encode(cff, items, num_items, outcomes);
+                long long count = cff_decode(cff, outcomes, expected, 2000);
+                assert(cff_decode_by_construction(cff, outcomes, decoded, 2000) == count);
+                assert(memcmp(decoded, expected, count * sizeof(long long)) == 0);
+            }
+            cff_free(cff);
+        }
+    }
+    cff_table_free(ctx);
+
+    // without a recipe it is cff_decode()
+    cff_t *sts = cff_sts(15);
+    long long items[2] = {3, 20}, decoded[4];
+    unsigned char outcomes[2];
+    encode(sts, items, 2, outcomes);
+    assert(cff_decode_by_construction(sts, outcomes, decoded, 4) == 2);
+    assert(decoded[0] == 3 && decoded[1] == 20);
+    cff_free(sts);
+    puts("OK test_cff_decode_by_construction passed");
+}
+
+// products of table CFFs keep their recipes, and are decoded factor by factor
+void test_cff_decode_by_construction_products()
+{
+    puts("Running test_cff_decode_by_construction_products...");
+    srand(36);
+    cff_table_ctx_t *ctx = cff_table_create(3, 100, 2000);
+    cff_t *a = cff_table_get_by_t(ctx, 2, 9);   // STS(9)
+    cff_t *b = cff_table_get_by_t(ctx, 2, 12);
+    cff_t *c = cff_table_get_by_t(ctx, 2, 16);
+    cff_t *outer = cff_table_get_by_n(ctx, 1, (int) cff_get_n(c));
+    cff_t *rs = cff_table_get_by_t(ctx, 3, 20); // RS(5^1;2;4)
+    cff_t *sum = cff_additive(a, b);
+    cff_t *products[] = {
+        cff_kronecker(a, b),
+        cff_kronecker(b, c),
+        cff_optimized_kronecker(outer, a, c),
+        cff_doubling(b, 7),
+        cff_kronecker(sum, a), // nested
+        cff_extend_by_one(sum),
+        cff_kronecker(rs, rs) // both factors over the same field
+    };
+    for (int i = 0; i < 7; i++)
+    {
+        cff_t *cff = products[i];
+        assert(cff != NULL);
+        long long n = cff_get_n(cff);
+        int t = cff_get_t(cff);
+        unsigned char *outcomes = malloc((t + 7) / 8);
+        long long *expected = malloc(n * sizeof(long long));
+        long long *decoded = malloc(n * sizeof(long long));
+        long long items[5];
+        for (int trial = 0; trial < 20; trial++)
+        {
+            int num_items = 1 + trial % 5; // up to d positives, and more
+            random_items(n, items, num_items);
+            encode(cff, items, num_items, outcomes);
+            long long count = cff_decode(cff, outcomes, expected, n);
+            assert(cff_decode_by_construction(cff, outcomes, decoded, n) == count);
+            assert(memcmp(decoded, expected, count * sizeof(long long)) == 0);
+            if (num_items <= 2)
+            { // within d the positives come back exactly
+                assert(count == num_items);
+            }
+        }
+        // all tests negative, and all positive
+        memset(outcomes, 0, (t + 7) / 8);
+        assert(cff_decode_by_construction(cff, outcomes, decoded, n) == 0);
+        memset(outcomes, 0xff, (t + 7) / 8);
+        assert(cff_decode_by_construction(cff, outcomes, NULL, 0) == n);
+        free(outcomes);
+        free(expected);
+        free(decoded);
+        cff_free(cff);
+    }
+    cff_free(sum);
+    cff_free(rs);
+    cff_free(a);
+    cff_free(b);
+    cff_free(c);
+    cff_free(outer);
+    cff_table_free(ctx);
+    puts("OK test_cff_decode_by_construction_products passed");
+}
+
+// the streaming decoder narrows the items down as outcomes arrive, and ends at cff_decode()
+void test_cff_decoder_stream()
+{
+    puts("Running test_cff_decoder_stream...");
+    srand(39);
+    cff_t *cff = cff_reed_solomon(11, 1, 2, 12); // 11-CFF(132,121)
+    int t = cff_get_t(cff);
+    long long n = cff_get_n(cff);
+    for (int trial = 0; trial < 20; trial++)
+    {
+        long long items[4];
+        int num_items = 1 + trial % 4;
+        random_items(n, items, num_items);
+        unsigned char outcomes[(132 + 7) / 8];
+        encode(cff, items, num_items, outcomes);
+        cff_decoder_t *dec = cff_decoder_create(cff);
+        assert(cff_decoder_get_items(dec, CFF_ITEM_AMBIGUOUS, NULL, 0) == n);
+
+        // in a random order
+        int order[132];
+        for (int r = 0; r < t; r++) order[r] = r;
+        for (int r = t - 1; r > 0; r--)
+        {
+            int j = rand() % (r + 1), swap = order[r];
+            order[r] = order[j];
+            order[j] = swap;
+        }
+        long long previous_negatives = 0;
+        for (int k = 0; k < t; k++)
+        {
+            int r = order[k];
+            assert(cff_decoder_add_outcome(dec, r, (outcomes[r / 8] >> (r % 8)) & 1) == 0);
+            long long negatives = cff_decoder_get_items(dec, CFF_ITEM_NEGATIVE, NULL, 0);
+            long long positives = cff_decoder_get_items(dec, CFF_ITEM_POSITIVE, NULL, 0);
+            long long ambiguous = cff_decoder_get_items(dec, CFF_ITEM_AMBIGUOUS, NULL, 0);
+            assert(negatives + positives + ambiguous == n);
+            assert(negatives >= previous_negatives);
+            previous_negatives = negatives;
+            // confirmed positives are really positive
+            long long confirmed[121];
+            cff_decoder_get_items(dec, CFF_ITEM_POSITIVE, confirmed, 121);
+            for (long long i = 0; i < positives; i++)
+            {
+                bool found = false;
+                for (int j = 0; j < num_items; j++) found |= items[j] == confirmed[i];
+                assert(found);
+            }
+        }
+        assert(cff_decoder_get_num_outcomes(dec) == t);
+        assert(cff_decoder_add_outcome(dec, 0, false) == -1);
+        assert(cff_decoder_add_outcome(dec, t, false) == -1);
+
+        // with every outcome in, at most d positives are all confirmed
+        long long decoded[121];
+        assert(cff_decoder_get_items(dec, CFF_ITEM_POSITIVE, decoded, 121) == num_items);
+        assert(memcmp(decoded, items, num_items * sizeof(long long)) == 0);
+        assert(cff_decoder_get_items(dec, CFF_ITEM_AMBIGUOUS, NULL, 0) == 0);
+        cff_decoder_free(dec);
+    }
+    cff_free(cff);
+    puts("OK test_cff_decoder_stream passed");
+}
+
+// with noise, the threshold decoder still finds the positives that cff_decode() loses
+void test_cff_decode_threshold()
+{
+    puts("Running test_cff_decode_threshold...");
+    srand(40);
+    cff_t *cff = cff_reed_solomon(11, 1, 2, 12); // 11-CFF(132,121), 12 tests per item
+    long long n = cff_get_n(cff);
+    long long items[3], decoded[121], expected[121], best[5];
+    double scores[5];
+    unsigned char outcomes[(132 + 7) / 8];
+    for (int trial = 0; trial < 20; trial++)
+    {
+        random_items(n, items, 3);
+        encode(cff, items, 3, outcomes);
+
+        // without noise a threshold of 1 is cff_decode()
+        long long count = cff_decode(cff, outcomes, expected, 121);
+        assert(cff_decode_threshold(cff, outcomes, 1.0, decoded, 121) == count);
+        assert(memcmp(decoded, expected, count * sizeof(long long)) == 0);
+
+        // a false negative in a test of each positive item
+        for (int i = 0; i < 3; i++)
+        {
+            for (int r = 0; r < cff_get_t(cff); r++)
+            {
+                if (cff_get_matrix_value(cff, r, (int) items[i]) == 1)
+                {
+                    outcomes[r / 8] &= ~(1 << (r % 8));
+                    break;
+                }
+            }
+        }
+        // and two false positives
+        for (int i = 0; i < 2; i++)
+        {
+            int r = rand() % cff_get_t(cff);
+            outcomes[r / 8] |= 1 << (r % 8);
+        }
+        assert(cff_decode(cff, outcomes, NULL, 0) < 3);
+        // an item shares at most 1 test with each other positive item, so a negative item
+        // scores at most 5/12 and a positive one at least 10/12
+        assert(cff_decode_threshold(cff, outcomes, 0.75, decoded, 121) == 3);
+        assert(memcmp(decoded, items, 3 * sizeof(long long)) == 0);
+
+        assert(cff_decode_top_k(cff, outcomes, 5, best, scores) == 5);
+        long long top[3] = {best[0], best[1], best[2]};
+        qsort(top, 3, sizeof(long long), compare_long_long);
+        assert(memcmp(top, items, 3 * sizeof(long long)) == 0);
+        for (int i = 0; i < 4; i++) assert(scores[i] >= scores[i + 1]);
+        assert(scores[2] >= 10.0 / 12 && scores[3] <= 5.0 / 12);
+    }
+    assert(cff_decode_top_k(cff, outcomes, 500, decoded, NULL) == n);
+
+    // every score is the fraction of the item's cells in positive tests
+    double all_scores[121];
+    assert(cff_decode_top_k(cff, outcomes, n, decoded, all_scores) == n);
+    for (long long i = 0; i < n; i++)
+    {
+        int hits = 0, weight = 0;
+        for (int r = 0; r < cff_get_t(cff); r++)
+        {
+            if (cff_get_matrix_value(cff, r, (int) decoded[i]) == 1)
+            {
+                weight++;
+                hits += (outcomes[r / 8] >> (r % 8)) & 1;
+            }
+        }
+        assert(all_scores[i] == (double) hits / weight);
+    }
+    cff_free(cff);
+    puts("OK test_cff_decode_threshold passed");
+}
+
+// a second stage resolves the items a too weak first stage left ambiguous
+void test_cff_follow_up_design()
+{
+    puts("Running test_cff_follow_up_design...");
+    srand(41);
+    cff_table_ctx_t *ctx = cff_table_create(3, 100, 2000);
+    cff_t *first = cff_sperner(500); // 1-CFF(12,500), with up to 3 positive items
+    long long n = cff_get_n(first);
+    unsigned char outcomes[2];
+    long long ambiguous[500];
+    int resolved_by_table = 0;
+    for (int trial = 0; trial < 30; trial++)
+    {
+        long long items[3];
+        int num_items = 1 + trial % 3;
+        random_items(n, items, num_items);
+        encode(first, items, num_items, outcomes);
+        long long m;
+        cff_t *second = cff_follow_up_design(ctx, first, outcomes, 3, 1000, ambiguous, 500, &m);
+        assert(m >= 0);
+        if (num_items == 1) assert(m == 0); // within the first stage's d nothing is ambiguous
+        if (m == 0)
+        {
+            assert(second == NULL);
+            continue;
+        }
+        assert(second != NULL && cff_get_n(second) == m && cff_get_t(second) <= m);
+        resolved_by_table += cff_get_t(second) < m;
+
+        // the ambiguous items are the ones cff_decoder_t leaves ambiguous
+        cff_decoder_t *dec = cff_decoder_create(first);
+        for (int r = 0; r < cff_get_t(first); r++)
+        {
+            cff_decoder_add_outcome(dec, r, (outcomes[r / 8] >> (r % 8)) & 1);
+        }
+        long long expected[500];
+        assert(cff_decoder_get_items(dec, CFF_ITEM_AMBIGUOUS, expected, 500) == m);
+        assert(memcmp(expected, ambiguous, m * sizeof(long long)) == 0);
+        cff_decoder_free(dec);
+
+        // the positives among the ambiguous items, from the second stage
+        long long second_items[3];
+        int k = 0;
+        for (long long j = 0; j < m; j++)
+        {
+            for (int i = 0; i < num_items; i++)
+            {
+                if (items[i] == ambiguous[j]) second_items[k++] = j;
+            }
+        }
+        unsigned char second_outcomes[(500 + 7) / 8];
+        encode(second, second_items, k, second_outcomes);
+        long long decoded[500];
+        assert(cff_decode(second, second_outcomes, decoded, 500) == k);
+        for (int i = 0; i < k; i++) assert(decoded[i] == second_items[i]);
+
+        // with no room for the items or the tests, there is no design
+        long long count;
+        assert(cff_follow_up_design(ctx, first, outcomes, 3, 1000, ambiguous, m - 1, &count) == NULL);
+        assert(count == m);
+        assert(cff_follow_up_design(ctx, first, outcomes, 3, cff_get_t(second) - 1, ambiguous, 500, &count) == NULL);
+        cff_free(second);
+    }
+    assert(resolved_by_table > 0);
+    cff_free(first);
+
+    // tests {0} and {0, 1, 2}, both positive: item 0 is confirmed, items 1 and 2 are ambiguous
+    int matrix[2][3] = {{1, 0, 0}, {1, 1, 1}};
+    first = cff_from_matrix(1, 2, 3, (int *) matrix);
+    outcomes[0] = 3;
+    long long m;
+    assert(cff_follow_up_design(ctx, first, outcomes, 1, 1000, ambiguous, 500, &m) == NULL);
+    assert(m == 0); // with d = 1 they are negative
+    cff_t *second = cff_follow_up_design(ctx, first, outcomes, 2, 1000, ambiguous, 500, &m);
+    assert(m == 2 && ambiguous[0] == 1 && ambiguous[1] == 2);
+    assert(second != NULL && cff_get_d(second) == 1 && cff_get_n(second) == 2 && cff_verify(second));
+    cff_free(second);
+    cff_free(first);
+
+    // tests {0} and {0, 1}, both positive: a single ambiguous item takes a single test
+    int matrix_2[2][2] = {{1, 0}, {1, 1}};
+    first = cff_from_matrix(1, 2, 2, (int *) matrix_2);
+    second = cff_follow_up_design(ctx, first, outcomes, 2, 1000, ambiguous, 500, &m);
+    assert(m == 1 && ambiguous[0] == 1);
+    assert(second != NULL && cff_get_d(second) == 0 && cff_get_t(second) == 1 && cff_get_n(second) == 1);
+    assert(cff_verify(second));
+    assert(cff_follow_up_design(ctx, first, outcomes, 2, 0, ambiguous, 500, &m) == NULL);
+    cff_free(second);
+    cff_free(first);
+    cff_table_free(ctx);
+    puts("OK test_cff_follow_up_design passed");
+}
+
+// the syndrome index gives the same positives as cff_decode() for up to d positives
+void test_cff_syndrome_index()
+{
+    puts("Running test_cff_syndrome_index...");
+    srand(42);
+    cff_t *cff = cff_sts(31); // 2-CFF(31,155)
+    long long n = cff_get_n(cff);
+    long long size = cff_syndrome_index_estimate_size(cff, 2);
+    assert(size > 0);
+    // 1 + 155 + 155 choose 2 = 12091 sets in 32768 slots of one key word, 2 items and a size
+    assert(size >= 32768LL * (8 + 16 + 1));
+    cff_syndrome_index_t *idx = cff_syndrome_index_create(cff, 2);
+    assert(idx != NULL);
+    unsigned char outcomes[4];
+    long long items[2], expected[155], decoded[155];
+    for (int trial = 0; trial < 200; trial++)
+    {
+        int num_items = trial % 3;
+        random_items(n, items, num_items);
+        encode(cff, items, num_items, outcomes);
+        long long count = cff_decode(cff, outcomes, expected, 155);
+        assert(count == num_items);
+        assert(cff_syndrome_index_lookup(idx, outcomes, decoded, 155) == count);
+        assert(memcmp(decoded, expected, count * sizeof(long long)) == 0);
+    }
+    // three positives are not in the index
+    long long three[3] = {0, 1, 2};
+    encode(cff, three, 3, outcomes);
+    assert(cff_syndrome_index_lookup(idx, outcomes, decoded, 155) == -1);
+    cff_syndrome_index_free(idx);
+
+    // d larger than the CFF's is refused
+    assert(cff_syndrome_index_create(cff, 3) == NULL);
+    // and so is a CFF whose d was raised above what it is
+    cff_t *sperner = cff_sperner(20);
+    cff_set_d(sperner, 2);
+    assert(cff_syndrome_index_create(sperner, 2) == NULL);
+    cff_free(sperner);
+    cff_free(cff);
+    puts("OK test_cff_syndrome_index passed");
+}
+
+int main()
+{
+    test_cff_decode_1();
+    test_cff_decode_2();
+    test_cff_decode_batch();
+    test_cff_decode_by_construction();
+    test_cff_decode_by_construction_products();
+    test_cff_decoder_stream();
+    test_cff_decode_threshold();
+    test_cff_follow_up_design();
+    test_cff_syndrome_index();
+
+    puts("ALL test_cff_decode tests passed");
+    return 0;
+}
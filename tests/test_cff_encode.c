@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <libcfftables/libcfftables.h>
+
+// a random bit-sliced item-by-batch matrix with up to max_items positives per vector
+static void random_batch(long long n, int batch_size, int max_items, uint64_t *items)
+{
+    int W = (batch_size + 63) / 64;
+    memset(items, 0, n * W * sizeof(uint64_t));
+    for (int b = 0; b < batch_size; b++)
+    {
+        int num_items = rand() % (max_items + 1);
+        for (int i = 0; i < num_items; i++)
+        {
+            long long c = rand() % n;
+            items[c * W + b / 64] |= (uint64_t) 1 << (b % 64);
+        }
+    }
+}
+
+// the outcome of test r in vector b, item by item
+static bool naive_outcome(const cff_t *cff, const uint64_t *items, int W, int r, int b)
+{
+    for (long long c = 0; c < cff_get_n(cff); c++)
+    {
+        if (cff_get_matrix_value(cff, r, (int) c) == 1 && ((items[c * W + b / 64] >> (b % 64)) & 1))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the batch encoder agrees with encoding item by item, for any number of threads
+void test_cff_encode_batch_1()
+{
+    puts("Running test_cff_encode_batch_1...");
+    srand(38);
+    cff_t *cffs[] = {
+        cff_sts(15),                    // 2-CFF(15,35)
+        cff_reed_solomon(11, 1, 2, 12), // 11-CFF(132,121)
+        cff_identity(4, 203)            // n not a multiple of 8
+    };
+    int batch_sizes[] = {1, 64, 100, 2500};
+    int thread_counts[] = {1, 3, 8};
+    for (int i = 0; i < 3; i++)
+    {
+        long long n = cff_get_n(cffs[i]);
+        int t = cff_get_t(cffs[i]);
+        for (int k = 0; k < 4; k++)
+        {
+            int W = (batch_sizes[k] + 63) / 64;
+            uint64_t *items = malloc(n * W * sizeof(uint64_t));
+            uint64_t *outcomes = malloc(t * W * sizeof(uint64_t));
+            uint64_t *first = malloc(t * W * sizeof(uint64_t));
+            random_batch(n, batch_sizes[k], 3, items);
+            for (int j = 0; j < 3; j++)
+            {
+                assert(cff_encode_batch(cffs[i], items, batch_sizes[k], outcomes, thread_counts[j]) == 0);
+                if (j == 0)
+                {
+                    for (int r = 0; r < t; r++)
+                    {
+                        for (int b = 0; b < batch_sizes[k]; b++)
+                        {
+                            bool got = (outcomes[r * W + b / 64] >> (b % 64)) & 1;
+                            assert(got == naive_outcome(cffs[i], items, W, r, b));
+                        }
+                    }
+                    memcpy(first, outcomes, t * W * sizeof(uint64_t));
+                } else
+                {
+                    assert(memcmp(first, outcomes, t * W * sizeof(uint64_t)) == 0);
+                }
+            }
+            free(items);
+            free(outcomes);
+            free(first);
+        }
+        cff_free(cffs[i]);
+    }
+    puts("OK test_cff_encode_batch_1 passed");
+}
+
+// encoding and then decoding a batch gives back up to d positives per vector
+void test_cff_encode_batch_2()
+{
+    puts("Running test_cff_encode_batch_2...");
+    srand(39);
+    cff_t *cff = cff_reed_solomon(7, 1, 2, 7); // 3-CFF(49,49)
+    int batch_size = 300, W = (batch_size + 63) / 64;
+    uint64_t items[49 * 5], outcomes[49 * 5];
+    random_batch(49, batch_size, 3, items);
+    assert(cff_encode_batch(cff, items, batch_size, outcomes, 4) == 0);
+    long long positives[300 * 3], counts[300];
+    assert(cff_decode_batch(cff, outcomes, batch_size, positives, 3, counts) == 0);
+    for (int b = 0; b < batch_size; b++)
+    {
+        int k = 0;
+        for (long long c = 0; c < 49; c++)
+        {
+            if ((items[c * W + b / 64] >> (b % 64)) & 1)
+            {
+                assert(k < counts[b] && positives[b * 3 + k] == c);
+                k++;
+            }
+        }
+        assert(k == counts[b]);
+    }
+    assert(cff_encode_batch(cff, items, 0, outcomes, 1) == -1);
+    assert(cff_encode_batch(NULL, items, batch_size, outcomes, 1) == -1);
+    cff_free(cff);
+    puts("OK test_cff_encode_batch_2 passed");
+}
+
+typedef struct
+{
+    int calls;
+    int flushed; // pools received
+    long long *sizes; // per test, the size of its pool when flushed, or -1
+    long long *sums; // per test, the sum of the items of its pool
+} pool_log_t;
+
+static void log_pools(int num_pools, const int *tests, const long long *const *pools,
+                      const long long *pool_sizes, void *user_data)
+{
+    pool_log_t *log = user_data;
+    log->calls++;
+    for (int i = 0; i < num_pools; i++)
+    {
+        assert(log->sizes[tests[i]] == -1); // each pool is flushed once
+        log->sizes[tests[i]] = pool_sizes[i];
+        log->sums[tests[i]] = 0;
+        for (long long j = 0; j < pool_sizes[i]; j++)
+        {
+            log->sums[tests[i]] += pools[i][j];
+        }
+        log->flushed++;
+    }
+}
+
+// the pools built as items arrive are the rows of the matrix
+void test_cff_pool_encoder()
+{
+    puts("Running test_cff_pool_encoder...");
+    srand(43);
+    cff_t *cff = cff_sts(15); // 2-CFF(15,35)
+    int t = cff_get_t(cff);
+    long long n = cff_get_n(cff);
+    long long sizes[15], sums[15];
+    pool_log_t log = {0, 0, sizes, sums};
+    for (int r = 0; r < t; r++)
+    {
+        sizes[r] = -1;
+    }
+    cff_pool_encoder_t *enc = cff_pool_encoder_create(cff, 4, log_pools, &log);
+    assert(enc != NULL);
+
+    // items arrive for the columns in a random order, item c + 1000 for column c
+    long long order[35];
+    for (long long c = 0; c < n; c++)
+    {
+        order[c] = c;
+    }
+    for (long long c = n - 1; c > 0; c--)
+    {
+        long long j = rand() % (c + 1), tmp = order[c];
+        order[c] = order[j];
+        order[j] = tmp;
+    }
+    for (long long i = 0; i < n; i++)
+    {
+        assert(cff_pool_encoder_add(enc, order[i] + 1000, order[i]) == 0);
+        assert(cff_pool_encoder_add(enc, 0, order[i]) == -1); // the column is taken
+        if (i == 0)
+        { // the pools of the first column have its item
+            for (int r = 0; r < t; r++)
+            {
+                long long size;
+                const long long *pool = cff_pool_encoder_get_pool(enc, r, &size);
+                assert(size == cff_get_matrix_value(cff, r, (int) order[0]));
+                assert(size == 0 || pool[0] == order[0] + 1000);
+            }
+        }
+    }
+    // every test of an STS(15) has 7 items, so the batches of 4 leave 15 % 4 pools waiting
+    assert(log.calls == 3 && log.flushed == 12);
+    assert(cff_pool_encoder_flush(enc, false) == 3);
+    assert(log.flushed == t);
+    for (int r = 0; r < t; r++)
+    {
+        long long size = 0, sum = 0;
+        for (long long c = 0; c < n; c++)
+        {
+            if (cff_get_matrix_value(cff, r, (int) c) == 1)
+            {
+                size++;
+                sum += c + 1000;
+            }
+        }
+        assert(sizes[r] == size && sums[r] == sum);
+    }
+    assert(cff_pool_encoder_flush(enc, true) == 0);
+    cff_pool_encoder_free(enc);
+
+    // at the end of intake the pools still missing items can be flushed as they are
+    log.calls = log.flushed = 0;
+    for (int r = 0; r < t; r++)
+    {
+        sizes[r] = -1;
+    }
+    enc = cff_pool_encoder_create(cff, 100, log_pools, &log);
+    assert(cff_pool_encoder_add(enc, 7, 0) == 0);
+    assert(cff_pool_encoder_add(enc, 8, n) == -1);
+    assert(cff_pool_encoder_flush(enc, false) == 0 && log.calls == 0);
+    assert(cff_pool_encoder_flush(enc, true) == t && log.calls == 1);
+    for (int r = 0; r < t; r++)
+    {
+        assert(sizes[r] == cff_get_matrix_value(cff, r, 0));
+        assert(sizes[r] == 0 || sums[r] == 7);
+    }
+    // the tests of the other columns were flushed, so their items would never reach the callback
+    for (long long c = 1; c < n; c++)
+    {
+        assert(cff_pool_encoder_add(enc, c + 1000, c) == -1);
+    }
+    for (int r = 0; r < t; r++)
+    {
+        long long size;
+        assert(cff_pool_encoder_get_pool(enc, r, &size) == NULL && size == 0);
+    }
+    assert(cff_pool_encoder_flush(enc, true) == 0);
+    cff_pool_encoder_free(enc);
+
+    assert(cff_pool_encoder_create(cff, 0, log_pools, &log) == NULL);
+    assert(cff_pool_encoder_create(cff, 1, NULL, NULL) == NULL);
+    cff_free(cff);
+    puts("OK test_cff_pool_encoder passed");
+}
+
+int main()
+{
+    test_cff_encode_batch_1();
+    test_cff_encode_batch_2();
+    test_cff_pool_encoder();
+
+    puts("ALL test_cff_encode tests passed");
+    return 0;
+}
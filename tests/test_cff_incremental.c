@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <libcfftables/libcfftables.h>
+
+// appends column c of a CFF to an incremental CFF
+static bool append_cff_column(cff_incremental_t *inc, const cff_t *cff, int c)
+{
+    int t = cff_get_t(cff);
+    int column[t];
+    for (int r = 0; r < t; r++)
+    {
+        column[r] = cff_get_matrix_value(cff, r, c);
+    }
+    return cff_incremental_append(inc, column);
+}
+
+// every column of a known CFF is accepted, and a column covered by two others is not
+void test_cff_incremental_1()
+{
+    puts("Running test_cff_incremental_1...");
+    cff_t *sts = cff_sts(13); // 2-CFF(13,26)
+    cff_incremental_t *inc = cff_incremental_create(2, 13);
+    for (int c = 0; c < cff_get_n(sts); c++)
+    {
+        assert(append_cff_column(inc, sts, c));
+    }
+    assert(cff_incremental_get_n(inc) == 26);
+
+    // the union of columns 0 and 1 is covered by them
+    int column[13];
+    for (int r = 0; r < 13; r++)
+    {
+        column[r] = cff_get_matrix_value(sts, r, 0) | cff_get_matrix_value(sts, r, 1);
+    }
+    assert(!cff_incremental_append(inc, column));
+    // and a repeated column is covered by its copy
+    assert(!append_cff_column(inc, sts, 5));
+    for (int r = 0; r < 13; r++)
+    {
+        column[r] = 0;
+    }
+    assert(!cff_incremental_append(inc, column));
+    assert(cff_incremental_get_n(inc) == 26);
+
+    cff_t *copy = cff_incremental_to_cff(inc);
+    assert(cff_get_n(copy) == 26 && cff_get_t(copy) == 13 && cff_get_d(copy) == 2);
+    for (int r = 0; r < 13; r++)
+    {
+        for (int c = 0; c < 26; c++)
+        {
+            assert(cff_get_matrix_value(copy, r, c) == cff_get_matrix_value(sts, r, c));
+        }
+    }
+    assert(cff_verify(copy));
+    cff_free(copy);
+    cff_incremental_free(inc);
+    cff_free(sts);
+    puts("OK test_cff_incremental_1 passed");
+}
+
+// greedy growth from random columns always agrees with cff_verify
+void test_cff_incremental_2()
+{
+    puts("Running test_cff_incremental_2...");
+    srand(2024);
+    int heights[] = {10, 24, 70};
+    for (int d = 1; d <= 3; d++)
+    {
+        for (int h = 0; h < 3; h++)
+        {
+            int t = heights[h];
+            cff_incremental_t *inc = cff_incremental_create(d, t);
+            for (int attempt = 0; attempt < 150; attempt++)
+            {
+                int column[t];
+                for (int r = 0; r < t; r++)
+                {
+                    column[r] = rand() % 4 == 0;
+                }
+                long long n = cff_incremental_get_n(inc);
+                bool accepted = cff_incremental_append(inc, column);
+                assert(cff_incremental_get_n(inc) == n + accepted);
+                if (n + 1 < d + 1) continue; // too few columns for cff_verify
+                // compare with a full check of the columns plus the candidate
+                cff_t *cff = cff_alloc(d, t, n + 1);
+                cff_t *current = cff_incremental_to_cff(inc);
+                for (int c = 0; c < n; c++)
+                {
+                    for (int r = 0; r < t; r++)
+                    {
+                        cff_set_matrix_value(cff, r, c, cff_get_matrix_value(current, r, c));
+                    }
+                }
+                for (int r = 0; r < t; r++)
+                {
+                    cff_set_matrix_value(cff, r, (int) n, column[r]);
+                }
+                assert(cff_verify(cff) == accepted);
+                cff_free(current);
+                cff_free(cff);
+            }
+            assert(cff_incremental_get_n(inc) > d);
+            cff_incremental_free(inc);
+        }
+    }
+    puts("OK test_cff_incremental_2 passed");
+}
+
+int main()
+{
+    test_cff_incremental_1();
+    test_cff_incremental_2();
+
+    puts("ALL test_cff_incremental tests passed");
+    return 0;
+}
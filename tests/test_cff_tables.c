@@ -1,4 +1,6 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <libcfftables/libcfftables.h>
 
@@ -114,6 +116,199 @@ void test_cff_table_write()
     puts("OK test_cff_table passed");
 }
 
+// loading saved tables gives the same rows and CFFs as creating them
+void test_cff_table_save_load()
+{
+    puts("Running test_cff_table_save_load...");
+    const char *path = "test_output/tables_4_100_5000.bin";
+    cff_table_ctx_t *ctx = cff_table_create(4, 100, 5000);
+    int saved = cff_table_save(ctx, path); // outside assert() so it also runs with NDEBUG
+    assert(saved == 0);
+    cff_table_ctx_t *loaded = cff_table_load(path, 4, 100, 5000);
+    assert(loaded != NULL);
+    for (int d = 2; d <= 4; d++) // the 1-CFF table is fixed, and its CFFs are too big to build
+    {
+        for (int t = 1; t <= 100; t += 3)
+        {
+            cff_t *made = cff_table_get_by_t(ctx, d, t);
+            cff_t *read = cff_table_get_by_t(loaded, d, t);
+            assert((made == NULL) == (read == NULL));
+            if (made != NULL)
+            {
+                assert(cff_get_n(made) == cff_get_n(read));
+                for (int r = 0; r < cff_get_t(made); r++)
+                {
+                    for (int c = 0; c < cff_get_n(made); c++)
+                    {
+                        assert(cff_get_matrix_value(made, r, c) == cff_get_matrix_value(read, r, c));
+                    }
+                }
+            }
+            cff_free(made);
+            cff_free(read);
+        }
+    }
+    cff_table_free(loaded);
+    cff_table_free(ctx);
+
+    // the file is only for the bounds it was saved with
+    assert(cff_table_load(path, 5, 100, 5000) == NULL);
+    assert(cff_table_load(path, 4, 101, 5000) == NULL);
+    assert(cff_table_load(path, 4, 100, 4999) == NULL);
+    assert(cff_table_load("test_output/no_such_file.bin", 4, 100, 5000) == NULL);
+
+    // a file that names rows that are not below the row is not loaded, even with a valid checksum
+    FILE *fptr = fopen(path, "rb");
+    assert(fptr != NULL);
+    unsigned char bytes[20000];
+    size_t size = fread(bytes, 1, sizeof(bytes), fptr);
+    fclose(fptr);
+    assert(size < sizeof(bytes));
+    unsigned char *table = bytes + 64; // the 1-CFF table
+    long long rows = table[4] | table[5] << 8;
+    table += 16 + rows * 20; // the 2-CFF table
+    rows = table[4] | table[5] << 8;
+    unsigned char *row = table + 16;
+    while (row[8] < 7) // built from other rows from extension by one (7) on
+    {
+        row += 20;
+        assert(row < table + 16 + rows * 20);
+    }
+    long long t = (row - table - 16) / 20;
+    row[10] = (unsigned char) t; // its first row is itself
+    row[11] = (unsigned char) (t >> 8);
+    unsigned long long checksum = 14695981039346656037ULL; // FNV-1a of the payload
+    for (size_t i = 64; i < size; i++)
+    {
+        checksum = (checksum ^ bytes[i]) * 1099511628211ULL;
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        bytes[52 + i] = (unsigned char) (checksum >> (8 * i));
+    }
+    const char *forged_path = "test_output/tables_forged.bin";
+    fptr = fopen(forged_path, "wb");
+    assert(fptr != NULL && fwrite(bytes, 1, size, fptr) == size);
+    fclose(fptr);
+    assert(cff_table_load(forged_path, 4, 100, 5000) == NULL);
+
+    // a damaged file is not loaded
+    fptr = fopen(path, "r+b");
+    assert(fptr != NULL);
+    fseek(fptr, 1000, SEEK_SET);
+    int byte = fgetc(fptr);
+    fseek(fptr, 1000, SEEK_SET);
+    fputc(byte ^ 1, fptr);
+    fclose(fptr);
+    assert(cff_table_load(path, 4, 100, 5000) == NULL);
+    puts("OK test_cff_table_save_load passed");
+}
+
+// the contents of <dir>/d_<d>.csv, malloc'd
+static char* read_csv(const char *dir, int d)
+{
+    char filename[1000];
+    snprintf(filename, sizeof(filename), "%s/d_%d.csv", dir, d);
+    FILE *fptr = fopen(filename, "rb");
+    assert(fptr != NULL);
+    fseek(fptr, 0, SEEK_END);
+    long size = ftell(fptr);
+    fseek(fptr, 0, SEEK_SET);
+    char *contents = calloc(size + 1, 1);
+    size_t read = fread(contents, 1, size, fptr);
+    assert(read == (size_t) size);
+    fclose(fptr);
+    return contents;
+}
+
+// the tables are the same as the checked-in ones, down to which construction each row records
+void test_cff_table_reference()
+{
+    puts("Running test_cff_table_reference...");
+    cff_table_ctx_t *ctx = cff_table_create(4, 200, 100000000);
+    cff_table_write_csv(ctx, "test_output");
+    cff_table_free(ctx);
+    for (int d = 1; d <= 4; d++)
+    {
+        char *expected = read_csv(CFF_TEST_REFERENCE_DIR "/tables_4_200_100000000", d);
+        char *got = read_csv("test_output", d);
+        assert(strcmp(got, expected) == 0);
+        free(got);
+        free(expected);
+    }
+    puts("OK test_cff_table_reference passed");
+}
+
+// tables within the bounds of the tables linked into the library (d <= 25) are the same as built ones
+void test_cff_table_embedded()
+{
+    puts("Running test_cff_table_embedded...");
+    long long bounds[3][2] = {{300, 1000000}, {100, 2000}, {2000, 100000000000000}};
+    for (int i = 0; i < 3; i++)
+    {
+        // the 26-CFF table is beyond the embedded tables, so all of these are built
+        cff_table_ctx_t *built = cff_table_create(26, (int) bounds[i][0], bounds[i][1]);
+        cff_table_write_csv(built, "test_output");
+        cff_table_free(built);
+        char *expected[6];
+        for (int d = 1; d <= 5; d++)
+        {
+            expected[d] = read_csv("test_output", d);
+        }
+        cff_table_ctx_t *ctx = cff_table_create(5, (int) bounds[i][0], bounds[i][1]);
+        cff_table_write_csv(ctx, "test_output");
+        cff_table_free(ctx);
+        for (int d = 1; d <= 5; d++)
+        {
+            char *got = read_csv("test_output", d);
+            assert(strcmp(got, expected[d]) == 0);
+            free(got);
+            free(expected[d]);
+        }
+    }
+    puts("OK test_cff_table_embedded passed");
+}
+
+// extended tables are the same as tables created with the new bounds
+void test_cff_table_extend()
+{
+    puts("Running test_cff_table_extend...");
+    // {d, t, n} created, then each extension, then the created tables to compare with
+    long long bounds[2][4][3] = {
+        {{26, 100, 1000}, {27, 300, 1000000}, {27, 300, 1000000000}, {27, 300, 1000000000}},
+        {{3, 100, 2000}, {5, 300, 1000000}, {2, 50, 100}, {5, 300, 1000000}} // then smaller bounds, kept
+    };
+    for (int i = 0; i < 2; i++)
+    {
+        int d_max = (int) bounds[i][3][0];
+        cff_table_ctx_t *built = cff_table_create(d_max, (int) bounds[i][3][1], bounds[i][3][2]);
+        cff_table_write_csv(built, "test_output");
+        cff_table_free(built);
+        char *expected[28];
+        for (int d = 1; d <= d_max; d++)
+        {
+            expected[d] = read_csv("test_output", d);
+        }
+        cff_table_ctx_t *ctx = cff_table_create((int) bounds[i][0][0], (int) bounds[i][0][1], bounds[i][0][2]);
+        for (int j = 1; j <= 2; j++)
+        {
+            int result = cff_table_extend(ctx, (int) bounds[i][j][0], (int) bounds[i][j][1], bounds[i][j][2]);
+            assert(result == 0);
+        }
+        cff_table_write_csv(ctx, "test_output");
+        cff_table_free(ctx);
+        for (int d = 1; d <= d_max; d++)
+        {
+            char *got = read_csv("test_output", d);
+            assert(strcmp(got, expected[d]) == 0);
+            free(got);
+            free(expected[d]);
+        }
+    }
+    assert(cff_table_extend(NULL, 5, 100, 1000) == -1);
+    puts("OK test_cff_table_extend passed");
+}
+
 int main()
 {
     test_cff_table_get_by_t_1();
@@ -127,6 +322,10 @@ int main()
     test_cff_table_get_by_n_4();
 
     test_cff_table_write();
+    test_cff_table_save_load();
+    test_cff_table_reference();
+    test_cff_table_embedded();
+    test_cff_table_extend();
 
     puts("ALL test_cff_tables passed");
 }
\ No newline at end of file
@@ -0,0 +1,515 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <libcfftables/libcfftables.h>
+
+// reference check: true if no column of the subset is covered by the others
+static bool subset_is_cover_free(const cff_t *cff, const int *cols, int k)
+{
+    for (int i = 0; i < k; i++)
+    {
+        bool has_private_row = false;
+        for (int r = 0; r < cff_get_t(cff) && !has_private_row; r++)
+        {
+            if (cff_get_matrix_value(cff, r, cols[i]) == 0) continue;
+            has_private_row = true;
+            for (int j = 0; j < k; j++)
+            {
+                if (j != i && cff_get_matrix_value(cff, r, cols[j]) == 1)
+                {
+                    has_private_row = false;
+                    break;
+                }
+            }
+        }
+        if (!has_private_row) return false;
+    }
+    return true;
+}
+
+// reference verification, independent of the library's kernels
+static bool reference_verify(const cff_t *cff)
+{
+    int k = cff_get_d(cff) + 1;
+    int n = (int) cff_get_n(cff);
+    if (k > n) return false;
+    int cols[8];
+    for (int i = 0; i < k; i++) cols[i] = i;
+    while (true)
+    {
+        if (!subset_is_cover_free(cff, cols, k)) return false;
+        int i = k - 1;
+        while (i >= 0 && cols[i] == n - k + i) i--;
+        if (i < 0) return true;
+        cols[i]++;
+        for (int j = i + 1; j < k; j++) cols[j] = cols[j-1] + 1;
+    }
+}
+
+// fills a cff with a random sparse matrix (density 1/density_inverse)
+static cff_t* random_cff(int d, int t, int n, int density_inverse)
+{
+    cff_t *cff = cff_alloc(d, t, n);
+    for (int r = 0; r < t; r++)
+    {
+        for (int c = 0; c < n; c++)
+        {
+            cff_set_matrix_value(cff, r, c, rand() % density_inverse == 0);
+        }
+    }
+    return cff;
+}
+
+// known CFFs pass the kernels for d = 1, 2, 3
+void test_cff_verify_kernels_1()
+{
+    puts("Running test_cff_verify_kernels_1...");
+    cff_t *sperner = cff_sperner(20);
+    assert(cff_verify(sperner));
+    cff_free(sperner);
+
+    cff_t *sts = cff_sts(15);
+    assert(cff_verify(sts));
+    cff_free(sts);
+
+    cff_t *rs = cff_reed_solomon(5, 1, 2, 4); // 3-CFF(20,25)
+    assert(cff_get_d(rs) == 3);
+    assert(cff_verify(rs));
+    // and a 4-CFF claim for it must fail
+    cff_set_d(rs, 4);
+    assert(!cff_verify(rs));
+    cff_free(rs);
+    puts("OK test_cff_verify_kernels_1 passed");
+}
+
+// kernels agree with a cell by cell reference on random matrices,
+// both for t <= 64 (one word per column) and t > 64
+void test_cff_verify_kernels_2()
+{
+    puts("Running test_cff_verify_kernels_2...");
+    srand(12345);
+    int heights[] = {6, 12, 64, 70, 150};
+    for (int d = 1; d <= 3; d++)
+    {
+        for (int h = 0; h < 5; h++)
+        {
+            for (int trial = 0; trial < 20; trial++)
+            {
+                int t = heights[h];
+                int n = d + 2 + rand() % 7;
+                cff_t *cff = random_cff(d, t, n, 2 + rand() % 3);
+                assert(cff_verify(cff) == reference_verify(cff));
+                cff_free(cff);
+            }
+        }
+    }
+    puts("OK test_cff_verify_kernels_2 passed");
+}
+
+// a matrix that is an identity matrix stacked above junk rows is a d-CFF for
+// every d; breaking one column must be caught in the multi word kernels
+void test_cff_verify_kernels_3()
+{
+    puts("Running test_cff_verify_kernels_3...");
+    int n = 9;
+    for (int d = 1; d <= 3; d++)
+    {
+        cff_t *cff = cff_alloc(d, 100, n);
+        for (int c = 0; c < n; c++)
+        {
+            cff_set_matrix_value(cff, 70 + c, c, 1);
+            cff_set_matrix_value(cff, c, c, 1);
+        }
+        assert(cff_verify(cff));
+        // column 4 is now the union of columns 3 and 5 (and so covered when d >= 2)
+        for (int r = 0; r < 100; r++)
+        {
+            cff_set_matrix_value(cff, r, 4, 0);
+        }
+        cff_set_matrix_value(cff, 3, 4, 1);
+        cff_set_matrix_value(cff, 75, 4, 1);
+        assert(cff_verify(cff) == (d < 2));
+        assert(cff_verify(cff) == reference_verify(cff));
+        cff_free(cff);
+    }
+    puts("OK test_cff_verify_kernels_3 passed");
+}
+
+// every CFF in small tables is certified by construction, and agrees with cff_verify
+void test_cff_verify_by_construction_1()
+{
+    puts("Running test_cff_verify_by_construction_1...");
+    cff_table_ctx_t *ctx = cff_table_create(3, 60, 2000);
+    for (int d = 1; d <= 3; d++)
+    {
+        // (the d = 1 table is not capped by n_max, so keep its CFFs small)
+        for (int t = d + 2; t <= (d == 1 ? 20 : 60); t++)
+        {
+            cff_t *cff = cff_table_get_by_t(ctx, d, t);
+            if (cff == NULL) continue;
+            assert(cff_verify_by_construction(cff));
+            if (cff_get_n(cff) <= 80)
+            {
+                assert(cff_verify(cff));
+            }
+            cff_free(cff);
+        }
+    }
+    cff_table_free(ctx);
+    puts("OK test_cff_verify_by_construction_1 passed");
+}
+
+// changing a cell, or claiming a larger d, breaks the certificate
+void test_cff_verify_by_construction_2()
+{
+    puts("Running test_cff_verify_by_construction_2...");
+    cff_table_ctx_t *ctx = cff_table_create(2, 40, 1000);
+    cff_t *cff = cff_table_get_by_t(ctx, 2, 30);
+    assert(cff != NULL);
+    assert(cff_verify_by_construction(cff));
+    cff_t *copy = cff_copy(cff);
+    assert(cff_verify_by_construction(copy));
+    cff_free(copy);
+
+    int v = cff_get_matrix_value(cff, 0, 0);
+    cff_set_matrix_value(cff, 0, 0, !v);
+    assert(!cff_verify_by_construction(cff));
+    cff_set_matrix_value(cff, 0, 0, v);
+    assert(cff_verify_by_construction(cff));
+
+    cff_set_d(cff, 3);
+    assert(!cff_verify_by_construction(cff));
+    cff_free(cff);
+    cff_table_free(ctx);
+
+    // CFFs not from the tables fall back to cff_verify
+    cff_t *sts = cff_sts(13);
+    assert(cff_verify_by_construction(sts));
+    cff_set_d(sts, 3);
+    assert(!cff_verify_by_construction(sts));
+    cff_free(sts);
+    puts("OK test_cff_verify_by_construction_2 passed");
+}
+
+// large products, far out of reach of cff_verify, are certified
+void test_cff_verify_by_construction_3()
+{
+    puts("Running test_cff_verify_by_construction_3...");
+    cff_table_ctx_t *ctx = cff_table_create(3, 400, 1000000);
+    cff_t *cff = cff_table_get_by_n(ctx, 3, 100000);
+    assert(cff != NULL);
+    assert(cff_get_n(cff) >= 100000);
+    assert(cff_verify_by_construction(cff));
+    cff_free(cff);
+    cff_table_free(ctx);
+    puts("OK test_cff_verify_by_construction_3 passed");
+}
+
+// progress callback state for the cff_verify_ex tests
+typedef struct progress_log
+{
+    int calls;
+    long long first_checked;
+    long long last_checked;
+    long long total;
+    volatile int *cancel; // set after the first report, if not NULL
+} progress_log_t;
+
+static void log_progress(long long checked, long long total, void *user_data)
+{
+    progress_log_t *log = user_data;
+    if (log->calls == 0) log->first_checked = checked;
+    log->calls++;
+    log->last_checked = checked;
+    log->total = total;
+    if (log->cancel != NULL) *log->cancel = 1;
+}
+
+// cff_verify_ex agrees with cff_verify, reports progress and returns a witness
+void test_cff_verify_ex_1()
+{
+    puts("Running test_cff_verify_ex_1...");
+    cff_t *sts = cff_sts(15);
+    progress_log_t log = {0};
+    cff_verify_options_t options = {0};
+    options.progress = log_progress;
+    options.user_data = &log;
+    options.checkpoint_interval = 50;
+    assert(cff_verify_ex(sts, &options, NULL, NULL) == CFF_VERIFY_VALID);
+    assert(log.total == 6545 && log.last_checked == 6545 && log.calls == 131); // 35 choose 3
+    cff_set_d(sts, 3);
+    assert(cff_verify_ex(sts, NULL, NULL, NULL) == CFF_VERIFY_INVALID);
+    cff_free(sts);
+
+    // column 4 is covered by columns 3 and 5, and only by them
+    cff_t *cff = cff_alloc(2, 20, 9);
+    for (int c = 0; c < 9; c++)
+    {
+        if (c == 4) continue;
+        cff_set_matrix_value(cff, c, c, 1);
+        cff_set_matrix_value(cff, 10 + c, c, 1);
+    }
+    cff_set_matrix_value(cff, 3, 4, 1);
+    cff_set_matrix_value(cff, 15, 4, 1);
+    long long witness[3], uncovered = -1;
+    assert(cff_verify_ex(cff, NULL, witness, &uncovered) == CFF_VERIFY_INVALID);
+    assert(witness[0] == 3 && witness[1] == 4 && witness[2] == 5);
+    assert(uncovered == 4);
+    cff_free(cff);
+    puts("OK test_cff_verify_ex_1 passed");
+}
+
+// a cancelled run leaves a checkpoint that the next run resumes from
+void test_cff_verify_ex_2()
+{
+    puts("Running test_cff_verify_ex_2...");
+    const char *path = "test_output/verify_checkpoint.txt";
+    remove(path);
+    cff_t *rs = cff_reed_solomon(5, 1, 2, 4); // 3-CFF(20,25)
+    volatile int cancel = 0;
+    progress_log_t log = {0};
+    log.cancel = &cancel;
+    cff_verify_options_t options = {0};
+    options.progress = log_progress;
+    options.user_data = &log;
+    options.cancel = &cancel;
+    options.checkpoint_interval = 1000;
+    options.checkpoint_path = path;
+    assert(cff_verify_ex(rs, &options, NULL, NULL) == CFF_VERIFY_CANCELLED);
+    assert(log.calls == 1 && log.last_checked == 1000);
+    FILE *f = fopen(path, "r");
+    assert(f != NULL);
+    fclose(f);
+
+    // resume: the first report is one chunk after the checkpoint
+    progress_log_t resumed = {0};
+    cancel = 0;
+    options.user_data = &resumed;
+    assert(cff_verify_ex(rs, &options, NULL, NULL) == CFF_VERIFY_VALID);
+    assert(resumed.first_checked == 2000);
+    assert(resumed.last_checked == 12650); // 25 choose 4
+    f = fopen(path, "r");
+    assert(f == NULL); // removed after finishing
+
+    // a checkpoint for a different matrix is ignored
+    cancel = 0;
+    log = (progress_log_t) {0};
+    log.cancel = &cancel;
+    options.user_data = &log;
+    assert(cff_verify_ex(rs, &options, NULL, NULL) == CFF_VERIFY_CANCELLED);
+    cff_set_matrix_value(rs, 0, 24, !cff_get_matrix_value(rs, 0, 24));
+    cancel = 0;
+    resumed = (progress_log_t) {0};
+    options.user_data = &resumed;
+    cff_verify_ex(rs, &options, NULL, NULL);
+    assert(resumed.first_checked <= 1000);
+    remove(path);
+
+    // a checkpoint that can't be written stops the run at the first chunk
+    progress_log_t unsaved = {0};
+    options.user_data = &unsaved;
+    options.cancel = NULL;
+    options.checkpoint_path = "test_output/no_such_directory/verify_checkpoint.txt";
+    assert(cff_verify_ex(rs, &options, NULL, NULL) == CFF_VERIFY_CHECKPOINT_FAILED);
+    assert(unsaved.calls == 1 && unsaved.last_checked == 1000);
+    cff_free(rs);
+    puts("OK test_cff_verify_ex_2 passed");
+}
+
+// automorphisms from the constructions give the same answers as the full check
+void test_cff_verify_with_symmetry_1()
+{
+    puts("Running test_cff_verify_with_symmetry_1...");
+    cff_table_ctx_t *ctx = cff_table_create(3, 60, 400);
+    for (int d = 2; d <= 3; d++)
+    {
+        for (int t = d + 2; t <= 60; t++)
+        {
+            cff_t *cff = cff_table_get_by_t(ctx, d, t);
+            if (cff == NULL) continue;
+            if (cff_get_n(cff) <= 150)
+            {
+                assert(cff_verify_with_symmetry(cff, NULL, 0) == reference_verify(cff));
+            }
+            cff_free(cff);
+        }
+    }
+    cff_table_free(ctx);
+
+    // the 3-CFF(20,25) from RS(5,2,4): the constant codewords and the others
+    ctx = cff_table_create(3, 20, 100);
+    cff_t *rs = cff_table_get_by_t(ctx, 3, 20);
+    int orbit_of[25];
+    assert(cff_get_n(rs) == 25);
+    assert(cff_column_orbits(rs, NULL, 0, orbit_of) == 2);
+    assert(orbit_of[0] == 0 && orbit_of[24] == 1);
+    assert(cff_verify_with_symmetry(rs, NULL, 0));
+
+    // clearing a cell of column 0 breaks every automorphism that moves it (and validity)
+    int r = 0;
+    while (cff_get_matrix_value(rs, r, 0) != 1) r++;
+    cff_set_matrix_value(rs, r, 0, 0);
+    assert(cff_column_orbits(rs, NULL, 0, orbit_of) > 2);
+    for (int c = 1; c < 25; c++)
+    {
+        assert(orbit_of[c] != 0);
+    }
+    assert(!reference_verify(rs));
+    assert(!cff_verify_with_symmetry(rs, NULL, 0));
+    cff_free(rs);
+    cff_table_free(ctx);
+    puts("OK test_cff_verify_with_symmetry_1 passed");
+}
+
+// user given generators: real automorphisms are used, others are ignored
+void test_cff_verify_with_symmetry_2()
+{
+    puts("Running test_cff_verify_with_symmetry_2...");
+    // the identity matrix is invariant under every column permutation
+    int n = 12;
+    cff_t *id = cff_identity(3, n);
+    long long generators[2 * 12];
+    for (int c = 0; c < n; c++)
+    {
+        generators[c] = (c + 1) % n;
+        generators[n + c] = c < 2 ? 1 - c : c;
+    }
+    assert(cff_column_orbits(id, generators, 2, NULL) == 1);
+    assert(cff_verify_with_symmetry(id, generators, 2));
+
+    // a CFF with a covered column: a bogus "automorphism" must not hide it
+    cff_t *cff = cff_alloc(1, 6, 6);
+    for (int c = 0; c < 6; c++)
+    {
+        cff_set_matrix_value(cff, c, c, 1);
+    }
+    cff_set_matrix_value(cff, 0, 5, 1); // column 0 is inside column 5
+    long long shift[6];
+    for (int c = 0; c < 6; c++)
+    {
+        shift[c] = (c + 1) % 6;
+    }
+    assert(cff_column_orbits(cff, shift, 1, NULL) == 6);
+    assert(!cff_verify_with_symmetry(cff, shift, 1));
+    assert(!cff_verify(cff));
+    cff_free(cff);
+    cff_free(id);
+
+    // without generators or a recipe this is the plain check
+    cff_t *sts = cff_sts(15);
+    assert(cff_column_orbits(sts, NULL, 0, NULL) == cff_get_n(sts));
+    assert(cff_verify_with_symmetry(sts, NULL, 0));
+    cff_free(sts);
+    puts("OK test_cff_verify_with_symmetry_2 passed");
+}
+
+// the witness columns are other than the uncovered column and their union contains it
+static bool witness_covers(const cff_t *cff, const long long *witness, int size, long long uncovered)
+{
+    for (int i = 0; i < size; i++)
+    {
+        if (witness[i] == uncovered) return false;
+    }
+    for (int r = 0; r < cff_get_t(cff); r++)
+    {
+        if (cff_get_matrix_value(cff, r, (int) uncovered) == 0) continue;
+        bool in_union = false;
+        for (int i = 0; i < size; i++)
+        {
+            in_union |= cff_get_matrix_value(cff, r, (int) witness[i]) == 1;
+        }
+        if (!in_union) return false;
+    }
+    return true;
+}
+
+// cff_compute_max_d agrees with the largest d that passes reference_verify,
+// and its witness really covers a column
+void test_cff_compute_max_d()
+{
+    puts("Running test_cff_compute_max_d...");
+    cff_t *rs = cff_reed_solomon(5, 1, 2, 4); // 3-CFF(20,25)
+    long long witness[64], uncovered;
+    int d = cff_compute_max_d(rs, witness, 64, &uncovered);
+    assert(d == 3);
+    assert(witness_covers(rs, witness, d + 1, uncovered));
+    cff_free(rs);
+
+    cff_t *sts = cff_sts(31); // two blocks never cover a third, but three can
+    d = cff_compute_max_d(sts, witness, 64, &uncovered);
+    assert(d == 2);
+    assert(witness_covers(sts, witness, d + 1, uncovered));
+    cff_free(sts);
+
+    cff_t *strong = cff_reed_solomon(11, 1, 2, 12); // an 11-CFF(132,121): covers need 12 columns
+    d = cff_compute_max_d(strong, witness, 64, &uncovered);
+    assert(d == 11);
+    assert(witness_covers(strong, witness, d + 1, uncovered));
+    cff_free(strong);
+
+    cff_table_ctx_t *ctx = cff_table_create(6, 80, 1000);
+    cff_t *table_cff = cff_table_get_by_t(ctx, 6, 80);
+    d = cff_compute_max_d(table_cff, witness, 64, &uncovered);
+    assert(d >= 6);
+    assert(witness_covers(table_cff, witness, d + 1, uncovered));
+    cff_free(table_cff);
+    cff_table_free(ctx);
+
+    cff_t *identity = cff_identity(3, 40); // no column is covered, however many others are taken
+    d = cff_compute_max_d(identity, witness, 64, &uncovered);
+    assert(d == 39 && uncovered == -1);
+    cff_free(identity);
+
+    srand(777);
+    for (int trial = 0; trial < 60; trial++)
+    {
+        int t = 8 + rand() % 70;
+        int n = 2 + rand() % 9;
+        cff_t *cff = random_cff(1, t, n, 2 + rand() % 4);
+        d = cff_compute_max_d(cff, witness, 64, &uncovered);
+        if (d < 0)
+        { // an empty column
+            for (int r = 0; r < t; r++) assert(cff_get_matrix_value(cff, r, (int) uncovered) == 0);
+            cff_free(cff);
+            continue;
+        }
+        // the largest d found by brute force
+        int expected = 0;
+        for (int e = 1; e < n && e <= 6; e++)
+        {
+            cff_set_d(cff, e);
+            if (reference_verify(cff)) expected = e;
+            else break;
+        }
+        assert(d == expected || (d > 6 && expected == 6));
+        if (d < n - 1)
+        {
+            assert(witness_covers(cff, witness, d + 1, uncovered));
+        }
+        else
+        {
+            assert(uncovered == -1);
+        }
+        cff_free(cff);
+    }
+    puts("OK test_cff_compute_max_d passed");
+}
+
+int main()
+{
+    test_cff_verify_kernels_1();
+    test_cff_verify_kernels_2();
+    test_cff_verify_kernels_3();
+    test_cff_verify_by_construction_1();
+    test_cff_verify_by_construction_2();
+    test_cff_verify_by_construction_3();
+    test_cff_verify_ex_1();
+    test_cff_verify_ex_2();
+    test_cff_verify_with_symmetry_1();
+    test_cff_verify_with_symmetry_2();
+    test_cff_compute_max_d();
+
+    puts("ALL test_cff_verify tests passed");
+    return 0;
+}